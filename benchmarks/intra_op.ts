@@ -0,0 +1,60 @@
+// Compare the latency and throughput of mv2 with different intra-op threads,
+// replicas and single-threaded execution.
+//
+// Usage: npx tsx benchmarks/intra_op.ts
+
+import os from 'node:os';
+import {execFileSync} from 'node:child_process';
+import {DType, Module, Tensor, getIntraOpThreads, setIntraOpThreads} from '..';
+
+const modelPath = `${__dirname}/../tests/fixtures/mv2.pte`;
+const executions = 64;
+
+async function benchmark(replicas: number, singleThreaded: boolean) {
+  const mod = new Module(modelPath, {replicas, singleThreaded});
+  await mod.load();
+  await mod.warmup();
+  const shape = mod.getMethods()[0].inputs[0].shape!;
+  const size = shape.reduce((a, b) => a * b, 1);
+  const input = new Tensor(Buffer.alloc(4 * size), DType.Float32, {shape});
+  // Keep one execution in flight for each replica.
+  let remaining = executions;
+  let latency = 0;
+  const start = process.hrtime.bigint();
+  await Promise.all(Array.from({length: replicas}, async () => {
+    while (remaining-- > 0) {
+      const begin = process.hrtime.bigint();
+      await mod.forward(input);
+      latency += Number(process.hrtime.bigint() - begin);
+    }
+  }));
+  const elapsed = Number(process.hrtime.bigint() - start);
+  return {
+    'latency (ms)': latency / executions / 1e6,
+    'throughput (/s)': executions / elapsed * 1e9,
+  };
+}
+
+async function main() {
+  // Running as child process with the threads, which can only be set once.
+  setIntraOpThreads(Number(process.env.ETJS_INTRA_OP_THREADS));
+  const cores = os.availableParallelism();
+  const results: Record<string, object> = {};
+  results['1 replica'] = await benchmark(1, false);
+  results[`${cores} replicas`] = await benchmark(cores, false);
+  results[`${cores} replicas single-threaded`] = await benchmark(cores, true);
+  console.log(JSON.stringify(results));
+}
+
+if (process.env.ETJS_INTRA_OP_THREADS) {
+  main();
+} else {
+  const threads = new Set([ 1, Math.max(getIntraOpThreads() >> 1, 1), getIntraOpThreads() ]);
+  for (const n of threads) {
+    const results = JSON.parse(execFileSync(process.execPath, process.execArgv.concat(process.argv.slice(1)), {
+      env: {...process.env, ETJS_INTRA_OP_THREADS: String(n)},
+    }).toString());
+    console.log(`Running mv2 with ${n} intra-op thread(s):`);
+    console.table(results);
+  }
+}
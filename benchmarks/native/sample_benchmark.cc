@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "src/philox.h"
+#include "src/sampling.h"
+
+namespace {
+
+std::vector<float> RandomLogits(size_t size) {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> dist(-10, 10);
+  std::vector<float> data(size);
+  for (float& value : data)
+    value = dist(rng);
+  return data;
+}
+
+// The filters run after the softmax, and their cost depends on how many
+// candidates pass the cutoff.
+void BM_SampleLogits(benchmark::State& state, etjs::SamplingOptions options) {
+  size_t size = state.range(0);
+  std::vector<float> logits = RandomLogits(size);
+  options.temperature = 0.7f;
+  options.generator = std::make_shared<etjs::Philox>(42);
+  for (auto _ : state) {
+    size_t token = etjs::SampleLogits(ea::ScalarType::Float, logits.data(),
+                                      size, options);
+    benchmark::DoNotOptimize(token);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+etjs::SamplingOptions TopP(float top_p) {
+  etjs::SamplingOptions options;
+  options.top_p = top_p;
+  return options;
+}
+
+etjs::SamplingOptions TopK(size_t top_k) {
+  etjs::SamplingOptions options;
+  options.top_k = top_k;
+  return options;
+}
+
+etjs::SamplingOptions MinP(float min_p) {
+  etjs::SamplingOptions options;
+  options.min_p = min_p;
+  return options;
+}
+
+BENCHMARK_CAPTURE(BM_SampleLogits, topP, TopP(0.9f))
+    ->Arg(32000)->Arg(128256)->Arg(256000);
+BENCHMARK_CAPTURE(BM_SampleLogits, topK, TopK(40))
+    ->Arg(32000)->Arg(128256)->Arg(256000);
+BENCHMARK_CAPTURE(BM_SampleLogits, minP, MinP(0.05f))
+    ->Arg(32000)->Arg(128256)->Arg(256000);
+
+}  // namespace
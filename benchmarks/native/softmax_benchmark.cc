@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+
+#include <random>
+#include <vector>
+
+#include "src/softmax.h"
+
+namespace er = executorch::runtime;
+
+namespace {
+
+std::vector<uint8_t> RandomLogits(ea::ScalarType dtype, size_t size) {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> dist(-10, 10);
+  std::vector<uint8_t> data(size * er::elementSize(dtype));
+  for (size_t i = 0; i < size; ++i) {
+    float value = dist(rng);
+    if (dtype == ea::ScalarType::Half)
+      reinterpret_cast<ea::Half*>(data.data())[i] = value;
+    else if (dtype == ea::ScalarType::BFloat16)
+      reinterpret_cast<ea::BFloat16*>(data.data())[i] = value;
+    else
+      reinterpret_cast<float*>(data.data())[i] = value;
+  }
+  return data;
+}
+
+// The softmax over the vocabulary dominates the time of sampling a token.
+void BM_Softmax(benchmark::State& state, ea::ScalarType dtype) {
+  size_t size = state.range(0);
+  std::vector<uint8_t> logits = RandomLogits(dtype, size);
+  std::vector<float> probs(size);
+  for (auto _ : state) {
+    etjs::Softmax(dtype, logits.data(), size, 0.7f, probs.data());
+    benchmark::DoNotOptimize(probs.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+  state.SetBytesProcessed(state.iterations() * logits.size());
+  state.SetLabel(etjs::GetSoftmaxKernelName());
+}
+
+BENCHMARK_CAPTURE(BM_Softmax, float32, ea::ScalarType::Float)
+    ->Arg(32000)->Arg(128256)->Arg(256000);
+BENCHMARK_CAPTURE(BM_Softmax, float16, ea::ScalarType::Half)
+    ->Arg(32000)->Arg(128256)->Arg(256000);
+BENCHMARK_CAPTURE(BM_Softmax, bfloat16, ea::ScalarType::BFloat16)
+    ->Arg(32000)->Arg(128256)->Arg(256000);
+
+}  // namespace
@@ -0,0 +1,27 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+
+#include "src/thread_pool.h"
+
+namespace {
+
+// Measure the overhead of dispatching small loops to the pool, which is paid
+// for every row of sampleBatch.
+void BM_ParallelFor(benchmark::State& state) {
+  size_t n = state.range(0);
+  etjs::ThreadPool* pool = etjs::ThreadPool::GetDefault();
+  std::atomic<size_t> sum = 0;
+  for (auto _ : state) {
+    pool->ParallelFor(n, [&sum](size_t i) {
+      sum.fetch_add(i, std::memory_order_relaxed);
+    });
+  }
+  benchmark::DoNotOptimize(sum.load());
+  state.SetItemsProcessed(state.iterations() * n);
+  state.counters["threads"] = pool->num_threads() + 1;
+}
+
+BENCHMARK(BM_ParallelFor)->Arg(1)->Arg(8)->Arg(64)->Arg(1024)->UseRealTime();
+
+}  // namespace
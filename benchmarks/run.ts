@@ -0,0 +1,237 @@
+// Measure the hot paths of the bindings: sampling, conversions of tensors and
+// executions of the mv2 model in sync, async, concurrent and prepared modes.
+//
+// Usage: npx tsx benchmarks/run.ts [--json] [--filter=<regex>] [--min-time=<seconds>]
+//
+// With --json the results are printed in the format of Google Benchmark, so
+// they can be compared with tools/compare.py from its repository, together
+// with the results of the native benchmarks.
+
+import os from 'node:os';
+import bindings from '../bindings.js';
+import {
+  DType,
+  Module,
+  Tensor,
+  getBufferPoolStats,
+  sample,
+} from '..';
+
+interface Case {
+  name: string;
+  // Number of operations running at the same time.
+  concurrency?: number;
+  // Number of items processed by one operation.
+  items?: number;
+  run: () => unknown;
+}
+
+interface Result {
+  name: string;
+  concurrency: number;
+  iterations: number;
+  meanNs: number;
+  p50Ns: number;
+  p90Ns: number;
+  p99Ns: number;
+  cpuNs: number;
+  opsPerSecond: number;
+  itemsPerSecond?: number;
+  allocationsPerOp: number;
+}
+
+const args = process.argv.slice(2);
+const json = args.includes('--json');
+const filter = new RegExp(args.find(a => a.startsWith('--filter='))?.slice(9) ?? '.');
+const minTimeMs = Number(args.find(a => a.startsWith('--min-time='))?.slice(11) ?? 1) * 1000;
+const warmupIterations = 10;
+
+function percentile(sorted: number[], p: number) {
+  return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+async function measure({name, concurrency = 1, items, run}: Case): Promise<Result> {
+  for (let i = 0; i < warmupIterations; ++i)
+    await run();
+  const latencies: number[] = [];
+  const allocations = getBufferPoolStats().allocations;
+  const cpu = process.cpuUsage();
+  const start = performance.now();
+  const deadline = start + minTimeMs;
+  // Each worker issues the next operation once the previous one finishes, so
+  // there are always |concurrency| operations in flight.
+  const worker = async () => {
+    do {
+      const begin = process.hrtime.bigint();
+      const result = run();
+      if (result instanceof Promise)
+        await result;
+      latencies.push(Number(process.hrtime.bigint() - begin));
+    } while (performance.now() < deadline);
+  };
+  await Promise.all(Array.from({length: concurrency}, worker));
+  const elapsedNs = (performance.now() - start) * 1e6;
+  const {user, system} = process.cpuUsage(cpu);
+  const iterations = latencies.length;
+  const sorted = latencies.sort((a, b) => a - b);
+  const opsPerSecond = iterations / elapsedNs * 1e9;
+  return {
+    name,
+    concurrency,
+    iterations,
+    // The latency of each operation, which is longer than the elapsed time per
+    // operation when they run concurrently.
+    meanNs: latencies.reduce((a, b) => a + b, 0) / iterations,
+    p50Ns: percentile(sorted, 0.5),
+    p90Ns: percentile(sorted, 0.9),
+    p99Ns: percentile(sorted, 0.99),
+    cpuNs: (user + system) * 1000 / iterations,
+    opsPerSecond,
+    itemsPerSecond: items ? opsPerSecond * items : undefined,
+    allocationsPerOp: (getBufferPoolStats().allocations - allocations) / iterations,
+  };
+}
+
+function randomLogits(vocabSize: number, dtype: DType) {
+  return new Tensor(Float32Array.from({length: vocabSize}, () => Math.random() * 20 - 10), dtype);
+}
+
+async function createCases(): Promise<Case[]> {
+  const cases: Case[] = [];
+
+  // Sampling from logits of common vocabulary sizes.
+  for (const vocabSize of [ 32000, 128256 ]) {
+    for (const dtype of [ DType.Float32, DType.Float16, DType.BFloat16 ]) {
+      const logits = randomLogits(vocabSize, dtype);
+      cases.push({
+        name: `sample/${DType[dtype]}/${vocabSize}`,
+        items: vocabSize,
+        run: () => sample(logits, {temperature: 0.7}),
+      });
+    }
+  }
+  const logits = randomLogits(128256, DType.Float32);
+  cases.push({
+    name: 'sample/Float32/128256/topK:40',
+    items: 128256,
+    run: () => sample(logits, {temperature: 0.7, topK: 40}),
+  });
+
+  // Conversions between tensors and JavaScript values.
+  const shape = [ 1, 3, 224, 224 ];
+  const pixels = new Float32Array(shape.reduce((a, b) => a * b));
+  const image = new Tensor(pixels, DType.Float32, {shape});
+  cases.push({
+    name: 'tensor/fromTypedArray/Float32',
+    items: pixels.length,
+    run: () => new Tensor(pixels, DType.Float32, {shape}),
+  });
+  cases.push({
+    name: 'tensor/fromTypedArray/Float16',
+    items: pixels.length,
+    run: () => new Tensor(pixels, DType.Float16, {shape}),
+  });
+  cases.push({
+    name: 'tensor/toTypedArray/Float32',
+    items: pixels.length,
+    run: () => image.toTypedArray(),
+  });
+  cases.push({
+    name: 'tensor/toTypedArray/Float64',
+    items: pixels.length,
+    run: () => image.toTypedArray({dtype: DType.Float64}),
+  });
+
+  // Executions of a real model.
+  const replicas = Math.min(4, os.availableParallelism());
+  const mod = new Module(`${__dirname}/../tests/fixtures/mv2.pte`, {replicas});
+  await mod.load();
+  const input = new Tensor(pixels, DType.Float32, {shape: mod.getMethods()[0].inputs[0].shape!});
+  const output = mod.forwardSync(input);
+  const forward = mod.prepare('forward');
+  cases.push({
+    name: 'mv2/forwardSync',
+    run: () => mod.forwardSync(input),
+  });
+  cases.push({
+    name: 'mv2/forward',
+    run: () => mod.forward(input),
+  });
+  cases.push({
+    name: 'mv2/forward/outputs',
+    run: () => mod.forward(input, {outputs: [ output ]}),
+  });
+  cases.push({
+    name: `mv2/forward/concurrency:${replicas}`,
+    concurrency: replicas,
+    run: () => mod.forward(input),
+  });
+  cases.push({
+    name: 'mv2/prepared/executeSync',
+    run: () => forward.executeSync(input),
+  });
+  cases.push({
+    name: 'mv2/prepared/execute',
+    run: () => forward.execute(input),
+  });
+
+  return cases.filter(c => filter.test(c.name));
+}
+
+function printTable(results: Result[]) {
+  const us = (ns: number) => Number((ns / 1000).toFixed(2));
+  console.table(Object.fromEntries(results.map(r => [ r.name, {
+    'iterations': r.iterations,
+    'mean (µs)': us(r.meanNs),
+    'p50 (µs)': us(r.p50Ns),
+    'p90 (µs)': us(r.p90Ns),
+    'p99 (µs)': us(r.p99Ns),
+    'ops/sec': Math.round(r.opsPerSecond),
+    'allocs/op': Number(r.allocationsPerOp.toFixed(2)),
+  } ])));
+}
+
+function printJson(results: Result[]) {
+  const context = {
+    date: new Date().toISOString(),
+    host_name: os.hostname(),
+    executable: process.execPath,
+    num_cpus: os.availableParallelism(),
+    mhz_per_cpu: os.cpus()[0]?.speed ?? 0,
+    library_build_type: bindings.config.toLowerCase(),
+    node_version: process.version,
+    softmax_kernel: bindings.softmaxKernel,
+  };
+  const benchmarks = results.map((r, index) => ({
+    name: r.name,
+    family_index: index,
+    per_family_instance_index: 0,
+    run_name: r.name,
+    run_type: 'iteration',
+    repetitions: 1,
+    repetition_index: 0,
+    threads: r.concurrency,
+    iterations: r.iterations,
+    real_time: r.meanNs,
+    cpu_time: r.cpuNs,
+    time_unit: 'ns',
+    items_per_second: r.itemsPerSecond ?? r.opsPerSecond,
+    p50: r.p50Ns,
+    p90: r.p90Ns,
+    p99: r.p99Ns,
+    allocations_per_op: r.allocationsPerOp,
+  }));
+  console.log(JSON.stringify({context, benchmarks}, null, 2));
+}
+
+async function main() {
+  const results: Result[] = [];
+  for (const c of await createCases())
+    results.push(await measure(c));
+  if (json)
+    printJson(results);
+  else
+    printTable(results);
+}
+
+main();
@@ -0,0 +1,56 @@
+// Measure the time of sampling from large logits.
+//
+// Usage: npx tsx benchmarks/sample.ts
+
+import {execFileSync} from 'node:child_process';
+import bindings from '../bindings.js';
+import {DType, SampleOptions, Tensor, sample} from '..';
+
+const iterations = 200;
+
+function benchmark(vocabSize: number, dtype: DType, options: SampleOptions) {
+  const logits = new Tensor(Array.from({length: vocabSize}, () => Math.random() * 20 - 10), dtype);
+  for (let i = 0; i < 10; ++i)
+    sample(logits, options);
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < iterations; ++i)
+    sample(logits, options);
+  return Number(process.hrtime.bigint() - start) / iterations / 1000;
+}
+
+// Compare the softmax kernels of different dtypes.
+const kernels = {
+  kernel: bindings.softmaxKernel,
+  float32: benchmark(128256, DType.Float32, {temperature: 0.7}),
+  float16: benchmark(128256, DType.Float16, {temperature: 0.7}),
+  bfloat16: benchmark(128256, DType.BFloat16, {temperature: 0.7}),
+};
+
+if (process.env.ETJS_DISABLE_SIMD) {
+  // Running as child process for the scalar kernel.
+  console.log(JSON.stringify(kernels));
+  process.exit(0);
+}
+
+const scalar = JSON.parse(execFileSync(process.execPath, process.execArgv.concat(process.argv.slice(1)), {
+  env: {...process.env, ETJS_DISABLE_SIMD: '1'},
+}).toString());
+console.log('Sampling from 128256 logits, microseconds per token:');
+console.table({[kernels.kernel]: kernels, [scalar.kernel]: scalar});
+
+// Compare the filters with different vocabulary sizes.
+const filters: Record<string, SampleOptions> = {
+  'multinomial': {},
+  'topP 0.9': {topP: 0.9},
+  'topK 40': {topK: 40},
+  'minP 0.05': {minP: 0.05},
+  'topK 40 topP 0.9': {topK: 40, topP: 0.9},
+};
+const results: Record<string, Record<string, number>> = {};
+for (const [name, options] of Object.entries(filters)) {
+  results[name] = {};
+  for (const vocabSize of [32000, 128256, 256000])
+    results[name][vocabSize] = benchmark(vocabSize, DType.Float32, options);
+}
+console.log('Sampling with filters, microseconds per token:');
+console.table(results);
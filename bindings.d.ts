@@ -48,21 +48,98 @@ export interface MethodMeta {
   memoryPlannedBufferSize(index: number): number | Error;
 }
 
+export interface BatchingStats {
+  batches: number;
+  requests: number;
+  items: number;
+  fillRatio: number;
+}
+
+export interface ProfileEvent {
+  name: string;
+  type: 'operator' | 'delegate';
+  start: number;
+  duration: number;
+  chainId?: number;
+  debugHandle?: number;
+}
+
+export interface ProfileRun {
+  method: string;
+  replica: number;
+  duration: number;
+  events: ProfileEvent[];
+}
+
+export interface WarmupResult {
+  method: string;
+  loadMs: number;
+  firstRunMs: number;
+  steadyRunMs?: number;
+}
+
+export interface MemoryUsage {
+  fileBytes: number;
+  residentBytes: number;
+}
+
+export interface LatencySummary {
+  count: number;
+  sumMs: number;
+  p50Ms: number;
+  p90Ms: number;
+  p99Ms: number;
+  maxMs: number;
+}
+
+export interface ExecutionStats {
+  calls: number;
+  errors: number;
+  copiedBytes: number;
+  allocations: number;
+  stages: Record<'queue' | 'inputs' | 'execute' | 'outputs' | 'reply' | 'convert' | 'total', LatencySummary>;
+}
+
 export class Module {
-  constructor(filePathOrBuffer: string | Uint8Array);
+  constructor(filePathOrBuffer: string | Uint8Array, replicas: number, profiling: boolean, loadMode: string, prefetch: string, shareProgram: boolean, singleThreaded: boolean);
   load(verification: 'minimal' | 'internal-consistency'): Promise<undefined | Error>;
   loadSync(verification: 'minimal' | 'internal-consistency'): undefined | Error;
   isLoaded(): boolean;
+  getMemoryUsage(): MemoryUsage | undefined | null;
+  getProgramRefCount(): number;
+  setAffinity(cpus: number[], pin: boolean): string;
+  getAffinityError(): string;
+  getIntraOpThreads(): number;
+  enableStats(): void;
+  getStats(reset: boolean): ExecutionStats | undefined | null;
   methodNames(): string[];
+  loadMethod(name: string): undefined | Error;
+  loadMethodAsync(name: string): Promise<undefined | Error>;
+  isMethodLoaded(name: string): boolean;
   methodMeta(name: string): MethodMeta | Error;
-  execute(name: string, args: unknown[]): Promise<unknown[] | string | Error>;
-  executeSync(name: string, args: unknown[]): unknown[] | string | Error;
+  getProfile(reset: boolean): ProfileRun[];
+  execute(name: string, args: unknown[], outputs: unknown[], cancel?: CancelToken): Promise<unknown[] | string | Error>;
+  executeSync(name: string, args: unknown[], outputs: unknown[]): unknown[] | string | Error;
+  enableBatching(name: string, maxBatchSize: number, maxWaitMs: number): string;
+  executeBatched(name: string, args: unknown[], cancel?: CancelToken): Promise<unknown[]>;
+  getBatchingStats(name: string, reset: boolean): BatchingStats | undefined;
+  warmup(name: string, iterations: number): Promise<WarmupResult | string>;
+  prepare(name: string): PreparedMethod | string;
+  generate(name: string, prompt: number[], maxTokens: number, sampling: SampleOptions, stopTokens: number[], kvCache: boolean | undefined, cancel: CancelToken, callback: (token: number | null, error?: string) => void): boolean;
+}
+
+export class PreparedMethod {
+  get name(): string;
+  get numInputs(): number;
+  execute(args: unknown[]): Promise<unknown[] | string | Error>;
+  executeSync(args: unknown[]): unknown[] | string | Error;
+  setInput(index: number, tensor: unknown): string;
 }
 
 export class Tensor {
-  constructor(data: Uint8Array | number[], dtype: number, shape: number[], dimOrder: number[], strides: number[]);
+  constructor(data: ArrayBufferView | number[], dtype: number, shape: number[], dimOrder: number[], strides: number[]);
   item(): number | boolean;
-  tolist(): Nested<number | boolean>;
+  toTypedArray(dtype: number): Int8Array | Uint8Array | Int16Array | Int32Array | BigInt64Array | Float32Array | Float64Array;
   get data(): Uint8Array;
   get dtype(): number;
   get shape(): number[];
@@ -71,6 +148,8 @@ export class Tensor {
   get size(): number;
   get nbytes(): number;
   get itemsize(): number;
+  get disposed(): boolean;
+  dispose(data: Uint8Array): void;
 }
 
 export interface Backends {
@@ -85,4 +164,43 @@ export const backends: Backends;
 export const config: 'Debug' | 'Release';
 
 export function elementSize(dtype: number): number;
-export function sample(tensor: Tensor, temperature: number, topP: number): number;
+
+export interface BufferPoolStats {
+  allocations: number;
+  reuses: number;
+  inUseBytes: number;
+  cachedBytes: number;
+  maxCachedBytes: number;
+}
+
+export function getBufferPoolStats(): BufferPoolStats;
+export function setBufferPoolLimit(maxCachedBytes: number): void;
+export function clearBufferPool(): void;
+
+export function getIntraOpThreads(): number;
+export function setIntraOpThreads(numThreads: number): string;
+
+export class CancelToken {
+  constructor(timeoutMs?: number);
+  cancel(): void;
+}
+
+export class Generator {
+  constructor(seed?: number);
+  seed(): number;
+  offset(): number;
+  setOffset(offset: number): void;
+  clone(): Generator;
+}
+
+export interface SampleOptions {
+  temperature?: number;
+  topP?: number;
+  topK?: number;
+  minP?: number;
+  generator?: Generator;
+}
+
+export function sample(tensor: Tensor, options: SampleOptions): number;
+export function sampleBatch(tensor: Tensor, options: SampleOptions[], dtype: number): Tensor;
+export const softmaxKernel: 'avx512' | 'avx2' | 'neon' | 'scalar';
@@ -0,0 +1,39 @@
+import bindings from '../bindings.js';
+
+/**
+ * Statistics of the pool that provides storage for tensors.
+ */
+export interface BufferPoolStats {
+  allocations: number;
+  /**
+   * Number of allocations that reused cached buffers.
+   */
+  reuses: number;
+  inUseBytes: number;
+  cachedBytes: number;
+  maxCachedBytes: number;
+}
+
+/**
+ * Return the statistics of the buffer pool.
+ */
+export function getBufferPoolStats(): BufferPoolStats {
+  return bindings.getBufferPoolStats();
+}
+
+/**
+ * Set the max bytes of freed tensor storage kept for reuse, the storage freed
+ * beyond it is returned to the system. Default is 256MB.
+ */
+export function setBufferPoolLimit(maxCachedBytes: number) {
+  if (!Number.isSafeInteger(maxCachedBytes) || maxCachedBytes < 0)
+    throw new Error('The maxCachedBytes must be a non-negative integer.');
+  bindings.setBufferPoolLimit(maxCachedBytes);
+}
+
+/**
+ * Release the cached storage of the buffer pool.
+ */
+export function clearBufferPool() {
+  bindings.clearBufferPool();
+}
@@ -1,5 +1,4 @@
 import bindings from '../bindings.js';
-import type {Tensor} from './tensor.js';
 
 /**
  * Data type.
@@ -16,20 +15,3 @@ export enum DType {
   Bool     = bindings.ScalarType.Bool,
   BFloat16 = bindings.ScalarType.BFloat16,
 }
-
-/**
- * Samples from the given tensor using a softmax over logits.
- */
-export function sample(logits: Tensor,
-                       {
-                         temperature = 1,
-                         topP = 1,
-                       }: {temperature?: number, topP?: number} = {}) {
-  if (logits.size == 0)
-    throw new Error('The logits must not be empty.');
-  if (logits.ndim == 0 ||
-      logits.ndim > 2 ||
-      logits.ndim == 2 && logits.shape[0] != 1)
-    throw new Error('The shape of logits must be [N] or [1, N].');
-  return bindings.sample(logits.holder, temperature, topP);
-}
@@ -1,4 +1,34 @@
 export {backends, config} from '../bindings.js';
-export {DType, sample} from './common.js';
-export {Module} from './module.js';
-export {Tensor} from './tensor.js';
+export {
+  BufferPoolStats,
+  getBufferPoolStats,
+  setBufferPoolLimit,
+  clearBufferPool,
+} from './buffer_pool.js';
+export {DType} from './common.js';
+export {getIntraOpThreads, setIntraOpThreads} from './intra_op.js';
+export {
+  Module,
+  ModuleOptions,
+  ExecuteOptions,
+  BatchingOptions,
+  BatchingStats,
+  ExecutionStats,
+  GenerateOptions,
+  LatencySummary,
+  PreparedMethod,
+  LoadMode,
+  MemoryUsage,
+  ProfileEvent,
+  ProfileRun,
+  WarmupOptions,
+  WarmupResult,
+} from './module.js';
+export {Generator} from './random.js';
+export {
+  SampleOptions,
+  SampleBatchOptions,
+  sample,
+  sampleBatch,
+} from './sample.js';
+export {SharedTensor, Tensor, TypedArray} from './tensor.js';
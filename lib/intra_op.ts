@@ -0,0 +1,27 @@
+import bindings from '../bindings.js';
+
+/**
+ * Return the number of threads used by XNNPACK and the optimized kernels to
+ * run one operator, which defaults to the number of performance cores.
+ */
+export function getIntraOpThreads(): number {
+  return bindings.getIntraOpThreads();
+}
+
+/**
+ * Set the number of threads used by XNNPACK and the optimized kernels to run
+ * one operator, which is shared by all modules in the process.
+ *
+ * @remarks
+ *
+ * Delegates keep the threadpool once a method is loaded, so this must be called
+ * before loading any method. When executions are already parallelized across
+ * requests with replicas, use the `singleThreaded` option of modules instead.
+ */
+export function setIntraOpThreads(numThreads: number) {
+  if (!Number.isInteger(numThreads) || numThreads < 1)
+    throw new Error('The numThreads must be a positive integer.');
+  const error = bindings.setIntraOpThreads(numThreads);
+  if (error)
+    throw new Error(error);
+}
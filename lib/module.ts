@@ -1,6 +1,7 @@
 import bindings from '../bindings.js';
 import {DType} from './common.js';
-import {Tensor} from './tensor.js';
+import {SampleOptions, parseSampleOptions} from './sample.js';
+import {Tensor, useTensorsUntil} from './tensor.js';
 
 /**
  * The supported types for conversions between C++ and JavaScript.
@@ -18,6 +19,300 @@ export interface EValueInfo {
   nbytes?: number;
 }
 
+/**
+ * Options for executing a method, passed as the last argument.
+ */
+export interface ExecuteOptions {
+  /**
+   * Preallocated tensors for receiving the outputs, which must have the same
+   * dtype and dim order with the method's outputs, and the shape of the outputs
+   * of this execution. Use `undefined` for outputs that should be returned as
+   * new tensors.
+   *
+   * @remarks
+   *
+   * When an output is not memory-planned, the method writes into the passed
+   * tensor directly during the call, which then must be large enough for the
+   * upper bound of the output's shape. Otherwise the output is copied into it.
+   */
+  outputs?: (Tensor | undefined)[];
+  /**
+   * Whether to return the tensor outputs not passed in `outputs` as tensors
+   * stored in SharedArrayBuffer, which can be passed to other workers without
+   * copying. The tensors are created with the upper bounds of the outputs'
+   * shapes, so the execution fails when an output of dynamic shape is smaller
+   * than its upper bound. Default is false.
+   */
+  sharedOutputs?: boolean;
+  /**
+   * Abort the execution with the signal. An execution that has not started is
+   * dropped, while a running one completes but its result is discarded. Only
+   * works for async executions.
+   */
+  signal?: AbortSignal;
+  /**
+   * Milliseconds after which the execution is dropped if it has not started.
+   * Only works for async executions.
+   */
+  timeout?: number;
+}
+
+/**
+ * Options for creating a module.
+ */
+export interface ModuleOptions {
+  /**
+   * Number of instances created for each method, which share the same loaded
+   * program but have their own memory, so async executions can run in
+   * parallel. Default is 1.
+   */
+  replicas?: number;
+  /**
+   * Whether to record the operator and delegate events of executions, which
+   * can be read with `getProfile`. Default is false.
+   */
+  profiling?: boolean;
+  /**
+   * How the model file is loaded, ignored when the module is created from a
+   * buffer. Default is `mmap-mlock-ignore-errors`.
+   *
+   * - `mmap`: map the file and page in the weights on demand.
+   * - `mmap-mlock`: map the file and lock the weights in memory, fail if the
+   *   weights can not be locked.
+   * - `mmap-mlock-ignore-errors`: same with `mmap-mlock` but ignore failures.
+   * - `file`: read the weights into memory.
+   */
+  loadMode?: LoadMode;
+  /**
+   * How to prefetch the model file when loading, ignored in `file` load mode.
+   * Default is `none`.
+   *
+   * - `none`: do nothing.
+   * - `advise`: advise the kernel to read ahead the file into the page cache.
+   * - `touch`: also read all pages of the file in a background thread.
+   */
+  prefetch?: 'none' | 'advise' | 'touch';
+  /**
+   * Whether to share the loaded program with other modules of the same file
+   * and load mode in this process, including the ones created in other worker
+   * threads. The weights are then only loaded once, while each module still
+   * has its own memory for methods. Default is true.
+   */
+  shareProgram?: boolean;
+  /**
+   * The CPUs that the threads running the module are bound to, see
+   * `setAffinity`. Default is not bound.
+   */
+  cpus?: number[];
+  /**
+   * Whether to bind the thread of each replica to one CPU of `cpus` in turn.
+   * Default is false.
+   */
+  pinThreads?: boolean;
+  /**
+   * Whether to run each operator on the calling thread only instead of the
+   * intra-op threadpool shared by all modules, which gives better throughput
+   * when concurrent executions already keep the cores busy. Default is false.
+   */
+  singleThreaded?: boolean;
+  /**
+   * Whether to record the latency breakdown of executions, which can be read
+   * with `stats`. Default is false.
+   */
+  collectStats?: boolean;
+}
+
+export type LoadMode = 'mmap' | 'mmap-mlock' | 'mmap-mlock-ignore-errors' | 'file';
+
+/**
+ * Memory used by the model file.
+ */
+export interface MemoryUsage {
+  fileBytes: number;
+  /**
+   * Bytes of the file resident in memory.
+   */
+  residentBytes: number;
+}
+
+/**
+ * Latency distribution of a stage of executions, in milliseconds.
+ */
+export interface LatencySummary {
+  count: number;
+  sumMs: number;
+  p50Ms: number;
+  p90Ms: number;
+  p99Ms: number;
+  maxMs: number;
+}
+
+/**
+ * Statistics of the executions of a module's methods.
+ */
+export interface ExecutionStats {
+  calls: number;
+  errors: number;
+  /**
+   * Bytes of outputs copied into caller's tensors or new tensors.
+   */
+  copiedBytes: number;
+  /**
+   * Number of tensors created for outputs.
+   */
+  allocations: number;
+  stages: {
+    /**
+     * Waiting in the queue of a replica, not recorded for sync executions.
+     */
+    queue: LatencySummary;
+    /**
+     * Converting arguments and setting them as inputs.
+     */
+    inputs: LatencySummary;
+    /**
+     * Running the method.
+     */
+    execute: LatencySummary;
+    /**
+     * Reading outputs and copying them into the passed tensors or new ones.
+     */
+    outputs: LatencySummary;
+    /**
+     * Waiting for the JavaScript thread to receive the result, not recorded
+     * for sync executions.
+     */
+    reply: LatencySummary;
+    /**
+     * Converting the outputs to JavaScript.
+     */
+    convert: LatencySummary;
+    total: LatencySummary;
+  };
+}
+
+/**
+ * Options for batching executions of a method.
+ */
+export interface BatchingOptions {
+  /**
+   * The max number of items in a batch, which is also limited by the upper
+   * bound of the batch dimension. Default is 8.
+   */
+  maxBatchSize?: number;
+  /**
+   * How long to wait for more executions before running a batch. Default is 1.
+   */
+  maxWaitMs?: number;
+}
+
+/**
+ * Statistics of batched executions.
+ */
+export interface BatchingStats {
+  batches: number;
+  requests: number;
+  items: number;
+  /**
+   * Average ratio of items in a batch to the max batch size.
+   */
+  fillRatio: number;
+}
+
+/**
+ * Options for warming up methods.
+ */
+export interface WarmupOptions {
+  /**
+   * Names of the methods to warm up. Default is all methods.
+   */
+  methods?: string[];
+  /**
+   * Number of executions in each replica. Default is 3.
+   */
+  iterations?: number;
+}
+
+/**
+ * Timings of warming up a method, in milliseconds.
+ */
+export interface WarmupResult {
+  method: string;
+  /**
+   * Time spent on loading the method in all replicas.
+   */
+  loadMs: number;
+  /**
+   * Mean time of the first execution in each replica.
+   */
+  firstRunMs: number;
+  /**
+   * Mean time of the following executions, which is not available when
+   * `iterations` is 1.
+   */
+  steadyRunMs?: number;
+}
+
+/**
+ * An operator or delegate event recorded during an execution.
+ */
+export interface ProfileEvent {
+  name: string;
+  type: 'operator' | 'delegate';
+  /**
+   * Milliseconds since the start of the execution.
+   */
+  start: number;
+  /**
+   * Duration of the event in milliseconds.
+   */
+  duration: number;
+  chainId?: number;
+  debugHandle?: number;
+}
+
+/**
+ * A profiled execution of a method.
+ */
+export interface ProfileRun {
+  method: string;
+  replica: number;
+  /**
+   * Duration of the execution in milliseconds.
+   */
+  duration: number;
+  events: ProfileEvent[];
+}
+
+/**
+ * Options for generating tokens.
+ */
+export interface GenerateOptions extends SampleOptions {
+  /**
+   * The max number of tokens to generate. Default is 128.
+   */
+  maxTokens?: number;
+  /**
+   * The generation stops when any of these tokens is sampled, which is not
+   * yielded.
+   */
+  stopTokens?: number[];
+  /**
+   * Whether the method takes the start position of tokens for its KV cache.
+   * Default is read from the `use_kv_cache` method exported with the model,
+   * or false if there is no such method.
+   */
+  kvCache?: boolean;
+  /**
+   * Stop the generation with the signal, which is checked before each step.
+   */
+  signal?: AbortSignal;
+  /**
+   * Milliseconds after which the generation stops with an error.
+   */
+  timeout?: number;
+}
+
 /**
  * Load exported edge PyTorch models.
  */
@@ -29,14 +324,42 @@ export class Module {
 
   // Internal binding to the executorch::extension::Module instance.
   readonly #mod: bindings.Module;
+  // Output infos of methods, cached for creating shared outputs.
+  readonly #outputInfos = new Map<string, EValueInfo[]>();
+  // Names of methods that have batching enabled.
+  readonly #batched = new Set<string>();
+  readonly #profiling: boolean;
 
   /**
    * @param filePathOrBuffer - When a string is passed, it is treated as file
    * path and will be loaded with mmap. When a Uint8Array is passed, its content
    * is used as the model file.
+   * @param options - Options for creating the module.
    */
-  constructor(filePathOrBuffer: string | Uint8Array) {
-    this.#mod = new bindings.Module(filePathOrBuffer);
+  constructor(filePathOrBuffer: string | Uint8Array,
+              {
+                replicas = 1,
+                profiling = false,
+                loadMode = 'mmap-mlock-ignore-errors',
+                prefetch = 'none',
+                shareProgram = true,
+                cpus,
+                pinThreads = false,
+                singleThreaded = false,
+                collectStats = false,
+              }: ModuleOptions = {}) {
+    if (!Number.isInteger(replicas) || replicas < 1)
+      throw new Error('The replicas must be a positive integer.');
+    if (![ 'mmap', 'mmap-mlock', 'mmap-mlock-ignore-errors', 'file' ].includes(loadMode))
+      throw new Error(`Invalid loadMode "${loadMode}".`);
+    if (![ 'none', 'advise', 'touch' ].includes(prefetch))
+      throw new Error(`Invalid prefetch "${prefetch}".`);
+    this.#mod = new bindings.Module(filePathOrBuffer, replicas, profiling, loadMode, prefetch, shareProgram, singleThreaded);
+    this.#profiling = profiling;
+    if (cpus)
+      this.setAffinity(cpus, {pin: pinThreads});
+    if (collectStats)
+      this.#mod.enableStats();
   }
 
   /**
@@ -66,6 +389,64 @@ export class Module {
     return this.#mod.isLoaded();
   }
 
+  /**
+   * Return the memory used by the model file, which is only available when the
+   * module is loaded from a file path with a `mmap` load mode.
+   */
+  getMemoryUsage(): MemoryUsage | undefined {
+    return this.#mod.getMemoryUsage() ?? undefined;
+  }
+
+  /**
+   * Return the number of modules in this process using the same loaded
+   * program, or 0 if not loaded.
+   */
+  getProgramRefCount(): number {
+    return this.#mod.getProgramRefCount();
+  }
+
+  /**
+   * Bind the threads running the module to CPUs.
+   *
+   * @remarks
+   *
+   * Loading and async executions of the module run on dedicated native threads
+   * instead of the libuv pool, one for each replica. Binding them to a set of
+   * CPUs keeps inference away from the cores serving requests, and memory
+   * allocated by the replicas is then placed on the NUMA node of their CPUs.
+   * Only supported on Linux and Windows.
+   *
+   * @param cpus - Indices of the CPUs, pass an empty array to unbind.
+   * @param options.pin - Whether to bind the thread of each replica to one CPU
+   * of `cpus` in turn, otherwise all threads can run on any of `cpus`.
+   */
+  setAffinity(cpus: number[], {pin = false}: {pin?: boolean} = {}) {
+    if (!cpus.every((cpu) => Number.isInteger(cpu) && cpu >= 0))
+      throw new Error('The cpus must be non-negative integers.');
+    const error = this.#mod.setAffinity(cpus, pin);
+    if (error)
+      throw new Error(error);
+  }
+
+  /**
+   * Return the error of binding the threads to the CPUs of `setAffinity`.
+   *
+   * @remarks
+   *
+   * Each thread applies the affinity before running its next task, so the
+   * failure can only be known after that.
+   */
+  getAffinityError(): string | undefined {
+    return this.#mod.getAffinityError() || undefined;
+  }
+
+  /**
+   * Return the number of threads used to run one operator of the module.
+   */
+  getIntraOpThreads(): number {
+    return this.#mod.getIntraOpThreads();
+  }
+
   /**
    * Return names of loaded model's methods.
    */
@@ -73,6 +454,82 @@ export class Module {
     return this.#mod.methodNames();
   }
 
+  /**
+   * Load the method in a worker thread, which otherwise would be loaded on the
+   * first execution.
+   *
+   * @param name - Name of the method.
+   */
+  async loadMethod(name: string) {
+    const error = await this.#mod.loadMethodAsync(name);
+    if (error)
+      throw error;
+  }
+
+  /**
+   * Load the method synchronously.
+   *
+   * @param name - Name of the method.
+   */
+  loadMethodSync(name: string) {
+    const error = this.#mod.loadMethod(name);
+    if (error)
+      throw error;
+  }
+
+  /**
+   * Return if the method has been loaded.
+   *
+   * @param name - Name of the method.
+   */
+  isMethodLoaded(name: string) {
+    return this.#mod.isMethodLoaded(name);
+  }
+
+  /**
+   * Prepare the method for repeated executions.
+   *
+   * @remarks
+   *
+   * The returned method is bound to one replica of the module, and its
+   * signature is read once, so executions skip looking up the method and
+   * reading its metadata. It is useful for small models where the overhead of
+   * calling into native code dominates.
+   *
+   * @param name - Name of the method.
+   */
+  prepare(name: string): PreparedMethod {
+    const method = this.#mod.prepare(name);
+    if (typeof method == 'string')
+      throw new Error(method);
+    return new PreparedMethod(this, method);
+  }
+
+  /**
+   * Load the methods and execute them with zero-filled inputs in a worker
+   * thread, so weights are paged in and delegates are initialized before
+   * serving requests.
+   *
+   * @remarks
+   *
+   * The inputs are created with the upper bound shapes of the method, and
+   * only tensor, integer, number and boolean inputs are supported.
+   *
+   * @param options - Options for warming up.
+   */
+  async warmup({methods, iterations = 3}: WarmupOptions = {}): Promise<WarmupResult[]> {
+    if (!Number.isInteger(iterations) || iterations < 1)
+      throw new Error('The iterations must be a positive integer.');
+    const results: WarmupResult[] = [];
+    for (const name of methods ?? this.getMethodNames()) {
+      const result = await this.#mod.warmup(name, iterations);
+      if (typeof result == 'string')
+        throw new Error(result);
+      results.push(result);
+    }
+    return results;
+  }
+
   /**
    * Return information about the methods in the model.
    */
@@ -105,24 +562,300 @@ export class Module {
     });
   }
 
+  /**
+   * Run concurrent async executions of the method in batches.
+   *
+   * @remarks
+   *
+   * The method's inputs and outputs must be tensors, with a dynamic batch
+   * dimension as the first dimension. The inputs of concurrent executions are
+   * concatenated along the batch dimension and run in one execution, whose
+   * outputs are split and returned to each caller.
+   *
+   * @param name - Name of the method.
+   * @param options - Options for batching.
+   */
+  enableBatching(name: string,
+                 {maxBatchSize = 8, maxWaitMs = 1}: BatchingOptions = {}) {
+    const error = this.#mod.enableBatching(name, maxBatchSize, maxWaitMs);
+    if (error)
+      throw new Error(error);
+    this.#batched.add(name);
+  }
+
+  /**
+   * Return statistics of batched executions of the method.
+   *
+   * @param name - Name of the method.
+   * @param reset - Whether to reset the statistics.
+   */
+  getBatchingStats(name: string, reset = false): BatchingStats | undefined {
+    return this.#mod.getBatchingStats(name, reset);
+  }
+
+  /**
+   * Return the finished executions that were profiled, ordered by replica
+   * and then time.
+   *
+   * @remarks
+   *
+   * The module must be created with the `profiling` option. Operator events
+   * are only recorded when the ExecuTorch runtime is built with event tracer
+   * enabled, otherwise only delegates that log events and the durations of
+   * executions are available.
+   *
+   * @param reset - Whether to clear the recorded executions.
+   */
+  getProfile(reset = false): ProfileRun[] {
+    if (!this.#profiling)
+      throw new Error('The module is not created with profiling enabled.');
+    return this.#mod.getProfile(reset);
+  }
+
+  /**
+   * Return the latency breakdown of executions of the methods.
+   *
+   * @remarks
+   *
+   * The module must be created with the `collectStats` option. Batched
+   * executions, prepared methods and generations are not recorded. The
+   * percentiles are estimated from log-scale buckets and are within 12.5% of
+   * the real values.
+   *
+   * @param reset - Whether to clear the recorded stats.
+   */
+  stats(reset = false): ExecutionStats {
+    const stats = this.#mod.getStats(reset);
+    if (!stats)
+      throw new Error('The module is not created with collectStats enabled.');
+    return stats;
+  }
+
+  /**
+   * Generate tokens autoregressively with the method.
+   *
+   * @remarks
+   *
+   * The method must take tokens of shape `[1, N]` with `Long` dtype, and when
+   * it has KV cache (see `kvCache` option), the start position of the tokens
+   * of shape `[1]` as the second argument. It must return the logits as the
+   * first output. The decode loop and sampling run in native code, and only
+   * the generated tokens are passed to JavaScript. The loop stops when the
+   * caller stops iterating.
+   *
+   * @param name - Name of the method.
+   * @param promptTokens - The tokens of prompt.
+   * @param options - Options for generating tokens.
+   */
+  async *generate(name: string,
+                  promptTokens: number[],
+                  {
+                    maxTokens = 128,
+                    stopTokens = [],
+                    kvCache,
+                    signal,
+                    timeout,
+                    ...sampling
+                  }: GenerateOptions = {}): AsyncGenerator<number> {
+    const samplingOptions = parseSampleOptions(sampling);
+    signal?.throwIfAborted();
+    // The token also stops the loop when the caller stops iterating.
+    const cancel = createCancelToken(timeout);
+    const tokens: number[] = [];
+    let done = false;
+    let error: string | undefined;
+    let wake: (() => void) | undefined;
+    this.#mod.generate(name, promptTokens, maxTokens, samplingOptions, stopTokens, kvCache, cancel, (token, err) => {
+      if (token === null) {
+        done = true;
+        error = err;
+      } else {
+        tokens.push(token);
+      }
+      wake?.();
+    });
+    const onAbort = () => cancel.cancel();
+    signal?.addEventListener('abort', onAbort);
+    try {
+      while (true) {
+        if (tokens.length > 0) {
+          yield tokens.shift()!;
+          continue;
+        }
+        if (done)
+          break;
+        await new Promise<void>((resolve) => wake = resolve);
+        wake = undefined;
+      }
+    } finally {
+      cancel.cancel();
+      signal?.removeEventListener('abort', onAbort);
+    }
+    if (error && signal?.aborted)
+      throw signal.reason;
+    if (error)
+      throw new Error(error);
+  }
+
   #populateMethods() {
     for (const name of this.getMethodNames()) {
-      this[name] = async function(...args: EValue[]) {
-        return executionResult(await this.#mod.execute(name, args));
+      this[name] = async function(...args: (EValue | ExecuteOptions)[]) {
+        const [ inputs, outputs, {signal, timeout} ] = this.#parseArgs(name, args);
+        return runCancelable(signal, timeout, async (cancel) => {
+          if (this.#batched.has(name) && outputs.length == 0)
+            return executionResult(await useTensorsUntil(inputs, this.#mod.executeBatched(name, inputs, cancel)), outputs);
+          return executionResult(await useTensorsUntil([ ...inputs, ...outputs ], this.#mod.execute(name, inputs, outputs, cancel)), outputs);
+        });
       };
-      this[name + 'Sync'] = function(...args: EValue[]) {
-        return executionResult(this.#mod.executeSync(name, args));
+      this[name + 'Sync'] = function(...args: (EValue | ExecuteOptions)[]) {
+        const [ inputs, outputs ] = this.#parseArgs(name, args);
+        return executionResult(this.#mod.executeSync(name, inputs, outputs), outputs);
       };
     }
   }
+
+  #parseArgs(name: string, args: (EValue | ExecuteOptions)[]): [ EValue[], (Tensor | undefined)[], ExecuteOptions ] {
+    const last = args[args.length - 1];
+    if (typeof last != 'object' || last instanceof Tensor)
+      return [ args as EValue[], [], {} ];
+    let outputs = last.outputs ?? [];
+    if (last.sharedOutputs)
+      outputs = this.#createSharedOutputs(name, outputs);
+    return [ args.slice(0, -1) as EValue[], outputs, last ];
+  }
+
+  // Fill the missing tensor outputs with tensors of SharedArrayBuffer, which
+  // the method writes into.
+  #createSharedOutputs(name: string, outputs: (Tensor | undefined)[]) {
+    let infos = this.#outputInfos.get(name);
+    if (!infos) {
+      const method = this.getMethods().find(m => m.name == name);
+      if (!method)
+        throw new Error(`Method "${name}" does not exist.`);
+      infos = method.outputs;
+      this.#outputInfos.set(name, infos);
+    }
+    return infos.map((info, i) => {
+      if (outputs[i] || info.tag != bindings.Tag.Tensor)
+        return outputs[i];
+      return Tensor.createShared(info.shape!, info.dtype!);
+    });
+  }
+}
+
+/**
+ * A method prepared for repeated executions, created by `Module.prepare`.
+ */
+export class PreparedMethod {
+  // Internal binding to the native prepared method.
+  readonly #method: bindings.PreparedMethod;
+  // The method runs in the module's replica, so the module must be kept alive.
+  readonly #module: Module;
+  // The bound inputs must be kept alive.
+  readonly #inputs: (Tensor | undefined)[] = [];
+
+  constructor(module: Module, method: bindings.PreparedMethod) {
+    this.#module = module;
+    this.#method = method;
+  }
+
+  /**
+   * Name of the method.
+   */
+  get name(): string {
+    return this.#method.name;
+  }
+
+  /**
+   * Bind the tensor as the input at `index`.
+   *
+   * @remarks
+   *
+   * When the method is executed without arguments, the bound tensors are used
+   * as inputs, so new data can be written into them between calls instead of
+   * creating new tensors. Pass `undefined` to unbind the input.
+   *
+   * @param index - Index of the input.
+   * @param tensor - A tensor of the input's dtype and shape.
+   */
+  setInput(index: number, tensor: Tensor | undefined) {
+    if (!Number.isInteger(index) || index < 0)
+      throw new Error('The index must be a non-negative integer.');
+    const error = this.#method.setInput(index, tensor);
+    if (error)
+      throw new Error(error);
+    this.#inputs[index] = tensor;
+  }
+
+  /**
+   * Return the tensor bound as the input at `index`.
+   */
+  getInput(index: number): Tensor | undefined {
+    return this.#inputs[index];
+  }
+
+  /**
+   * Execute the method in the replica's queue, with the bound inputs when no
+   * argument is passed.
+   */
+  async execute(...args: EValue[]): Promise<EValue | EValue[]> {
+    const used = args.length > 0 ? args : this.#inputs;
+    return executionResult(await useTensorsUntil(used, this.#method.execute(args)), noOutputs) as EValue | EValue[];
+  }
+
+  /**
+   * Execute the method synchronously, with the bound inputs when no argument
+   * is passed.
+   */
+  executeSync(...args: EValue[]): EValue | EValue[] {
+    return executionResult(this.#method.executeSync(args), noOutputs) as EValue | EValue[];
+  }
+}
+
+const noOutputs: (Tensor | undefined)[] = [];
+
+// Run the task with a native cancel token that is cancelled when the signal
+// aborts or the timeout passes, and throw the abort reason on failure or when
+// the signal aborts while the task is running.
+async function runCancelable<T>(signal: AbortSignal | undefined,
+                                timeout: number | undefined,
+                                task: (cancel?: bindings.CancelToken) => Promise<T>): Promise<T> {
+  if (!signal && timeout === undefined)
+    return task();
+  signal?.throwIfAborted();
+  const cancel = createCancelToken(timeout);
+  const onAbort = () => cancel.cancel();
+  signal?.addEventListener('abort', onAbort);
+  try {
+    const result = await task(cancel);
+    signal?.throwIfAborted();
+    return result;
+  } catch (error) {
+    if (signal?.aborted)
+      throw signal.reason;
+    throw error;
+  } finally {
+    signal?.removeEventListener('abort', onAbort);
+  }
+}
+
+function createCancelToken(timeout: number | undefined) {
+  if (timeout !== undefined && !(timeout >= 0))
+    throw new Error('The timeout must be a non-negative number.');
+  return new bindings.CancelToken(timeout);
 }
 
-function executionResult(result: unknown[] | string | Error) {
+function executionResult(result: unknown[] | string | Error,
+                         outputs: (Tensor | undefined)[]) {
   if (result instanceof Error)
     throw result;
   if (typeof result == 'string')
     throw new Error(result);
-  const evalues = result.map(r => r instanceof bindings.Tensor ? new Tensor(r) : r);
+  const evalues = result.map((r, i) => {
+    if (outputs[i])
+      return outputs[i];
+    return r instanceof bindings.Tensor ? new Tensor(r) : r;
+  });
   if (evalues.length == 1)
     return evalues[0];
   else
@@ -0,0 +1,57 @@
+import bindings from '../bindings.js';
+
+/**
+ * Counter-based random number generator used for sampling.
+ *
+ * @remarks
+ *
+ * The numbers drawn from a generator only depend on its seed and offset, so
+ * a generator can be used concurrently by async tasks and still produce
+ * reproducible results when the order of draws is fixed.
+ */
+export class Generator {
+  // Internal binding to the etjs::Generator instance.
+  readonly holder: bindings.Generator;
+
+  /**
+   * @param seed - An integer used as seed, a random one is used when not
+   * specified.
+   */
+  constructor(seed?: number | bindings.Generator) {
+    if (seed instanceof bindings.Generator) {
+      this.holder = seed;
+      return;
+    }
+    if (seed !== undefined && (!Number.isSafeInteger(seed) || seed < 0))
+      throw new Error('The seed must be a non-negative safe integer.');
+    this.holder = new bindings.Generator(seed);
+  }
+
+  /**
+   * The seed of the generator.
+   */
+  get seed(): number {
+    return this.holder.seed();
+  }
+
+  /**
+   * Number of random numbers that have been drawn, can be set to replay or
+   * skip numbers.
+   */
+  get offset(): number {
+    return this.holder.offset();
+  }
+
+  set offset(value: number) {
+    if (!Number.isSafeInteger(value) || value < 0)
+      throw new Error('The offset must be a non-negative safe integer.');
+    this.holder.setOffset(value);
+  }
+
+  /**
+   * Return a new generator with the same seed and offset.
+   */
+  clone() {
+    return new Generator(this.holder.clone());
+  }
+}
@@ -0,0 +1,121 @@
+import bindings from '../bindings.js';
+import {DType} from './common.js';
+import {Generator} from './random.js';
+import {Tensor} from './tensor.js';
+
+/**
+ * Options for sampling from logits.
+ */
+export interface SampleOptions {
+  /**
+   * The logits are divided by temperature before softmax, 0 means always
+   * picking the most likely token. Default is 1.
+   */
+  temperature?: number;
+  /**
+   * Only sample from the smallest set of tokens whose probabilities add up to
+   * `topP`. Default is 1.
+   */
+  topP?: number;
+  /**
+   * Only sample from the `topK` most likely tokens, 0 means no limit. Default
+   * is 0.
+   */
+  topK?: number;
+  /**
+   * Only sample from tokens whose probabilities are at least `minP` times of
+   * the most likely token's. Default is 0.
+   */
+  minP?: number;
+  /**
+   * The random number generator, a shared default one is used when not set.
+   */
+  generator?: Generator;
+}
+
+/**
+ * Samples from the given tensor using a softmax over logits.
+ *
+ * @remarks
+ *
+ * When multiple filters are set, they are applied in the order of minP, topK
+ * and then topP.
+ */
+export function sample(logits: Tensor, options: SampleOptions = {}) {
+  if (logits.disposed)
+    throw new Error('The logits have been disposed.');
+  if (logits.size == 0)
+    throw new Error('The logits must not be empty.');
+  if (logits.ndim == 0 ||
+      logits.ndim > 2 ||
+      logits.ndim == 2 && logits.shape[0] != 1)
+    throw new Error('The shape of logits must be [N] or [1, N].');
+  return bindings.sample(logits.holder, parseSampleOptions(options));
+}
+
+/**
+ * Options for sampling from batched logits, the numbers can be arrays that
+ * provide an option for each row.
+ */
+export interface SampleBatchOptions {
+  temperature?: number | number[];
+  topP?: number | number[];
+  topK?: number | number[];
+  minP?: number | number[];
+  generator?: Generator;
+  /**
+   * The dtype of returned tokens, must be Int32 or Int64. Default is Int64.
+   */
+  dtype?: DType;
+}
+
+/**
+ * Sample a token from each row of the logits of shape `[B, N]`, and return a
+ * tensor of shape `[B]` with the tokens.
+ *
+ * @remarks
+ *
+ * The rows are sampled in parallel in native threads when the batch is large.
+ * The logits can be a strided view as long as the last dimension is
+ * contiguous.
+ */
+export function sampleBatch(logits: Tensor,
+                            {
+                              dtype = DType.Int64,
+                              generator,
+                              ...options
+                            }: SampleBatchOptions = {}) {
+  if (logits.disposed)
+    throw new Error('The logits have been disposed.');
+  if (logits.ndim != 2 || logits.size == 0)
+    throw new Error('The shape of logits must be [B, N] and not empty.');
+  if (logits.strides[1] != 1)
+    throw new Error('The last dimension of logits must be contiguous.');
+  if (dtype != DType.Int32 && dtype != DType.Int64)
+    throw new Error('The dtype of tokens must be Int32 or Int64.');
+  const batchSize = logits.shape[0];
+  // The random numbers of rows are drawn in order from the same generator.
+  const rows: bindings.SampleOptions[] = [];
+  for (let i = 0; i < batchSize; ++i) {
+    const row: Record<string, number | undefined> = {};
+    for (const [ key, value ] of Object.entries(options)) {
+      if (Array.isArray(value) && value.length != batchSize)
+        throw new Error(`The length of ${key} must be the batch size.`);
+      row[key] = Array.isArray(value) ? value[i] : value;
+    }
+    rows.push(parseSampleOptions({...row, generator}));
+  }
+  return new Tensor(bindings.sampleBatch(logits.holder, rows, dtype));
+}
+
+/**
+ * Validate the sampling options and convert them for bindings.
+ */
+export function parseSampleOptions({generator, ...options}: SampleOptions): bindings.SampleOptions {
+  const {topK = 0, minP = 0} = options;
+  if (!Number.isInteger(topK) || topK < 0)
+    throw new Error('The topK must be a non-negative integer.');
+  if (minP < 0 || minP > 1)
+    throw new Error('The minP must be between 0 and 1.');
+  return {...options, generator: generator?.holder};
+}
@@ -3,6 +3,14 @@ import {DType} from './common.js';
 
 type Nested<T> = Nested<T>[] | T;
 
+/**
+ * TypedArrays that can be used to create tensors.
+ */
+export type TypedArray = Int8Array | Uint8Array | Uint8ClampedArray |
+                         Int16Array | Uint16Array | Int32Array | Uint32Array |
+                         Float32Array | Float64Array |
+                         BigInt64Array | BigUint64Array;
+
 /**
  * Optional options describing the tensor.
  */
@@ -12,6 +20,20 @@ export interface TensorOptions {
   strides?: number[];
 }
 
+/**
+ * A tensor stored in SharedArrayBuffer, which can be posted to other workers
+ * and turned back into a tensor with `Tensor.fromShared` without copying.
+ */
+export interface SharedTensor {
+  buffer: SharedArrayBuffer;
+  byteOffset: number;
+  byteLength: number;
+  dtype: DType;
+  shape: number[];
+  dimOrder: number[];
+  strides: number[];
+}
+
 /**
  * A multi-dimensional matrix containing elements of a single data type.
  */
@@ -33,14 +55,15 @@ export class Tensor {
   readonly holder: bindings.Tensor;
 
   /**
-   * @param input - A scalar, or a (nested) Array, or a Uint8Array buffer.
+   * @param input - A scalar, or a (nested) Array, or a Uint8Array buffer, or a
+   * TypedArray of elements.
    * @param dtype - The data type of the elements.
    * @param options - Extra information of the tensor.
    * @param options.shape
    * @param options.dimOrder
    * @param options.strides
    */
-  constructor(input: Nested<boolean | number> | Uint8Array | bindings.Tensor,
+  constructor(input: Nested<boolean | number> | TypedArray | bindings.Tensor,
               dtype?: DType,
               {shape, dimOrder = [], strides = []}: TensorOptions = {}) {
     if (input instanceof Uint8Array) {
@@ -53,6 +76,33 @@ export class Tensor {
       this.shape = shape;
       this.data = input;
       this.holder = new bindings.Tensor(this.data, this.dtype, this.shape, dimOrder, strides);
+    } else if (ArrayBuffer.isView(input) && !(input instanceof DataView)) {
+      // Initialized from elements of TypedArray.
+      const length = (input as TypedArray).length;
+      const inputDType = getTypedArrayDType(input);
+      if (dtype === undefined && inputDType === undefined)
+        throw new Error(`Must provide dtype when input is ${input.constructor.name}.`);
+      this.dtype = dtype ?? inputDType!;
+      this.shape = shape ?? [ length ];
+      if (length < getSizeFromShape(this.shape))
+        throw new Error('The input has less data than set by passed shape.');
+      let array = input as TypedArray;
+      if (isFloat16Array(input)) {
+        // Float16Array is not supported by N-API, pass its bytes directly or
+        // convert it to Float32Array.
+        array = this.dtype == DType.Float16 ?
+          new Uint8Array(input.buffer, input.byteOffset, input.byteLength) :
+          Float32Array.from(input as unknown as ArrayLike<number>);
+      }
+      this.holder = new bindings.Tensor(array, this.dtype, this.shape, dimOrder, strides);
+      if (inputDType == this.dtype) {
+        // The tensor is a view of input's data.
+        this.data = new Uint8Array(input.buffer, input.byteOffset, input.byteLength);
+      } else {
+        // The elements were casted into tensor's own storage.
+        this.data = this.holder.data;
+        Object.defineProperty(this.data, 'holder', {enumerable: false, value: this.holder});
+      }
     } else if (input instanceof bindings.Tensor) {
       // Wrap an existing binding.
       this.dtype = input.dtype;
@@ -77,6 +127,57 @@ export class Tensor {
     }
   }
 
+  /**
+   * Create a zero-filled tensor stored in a new SharedArrayBuffer.
+   */
+  static createShared(shape: number[], dtype: DType = DType.Float32): Tensor {
+    const buffer = new SharedArrayBuffer(getSizeFromShape(shape) * bindings.elementSize(dtype));
+    return new Tensor(new Uint8Array(buffer), dtype, {shape});
+  }
+
+  /**
+   * Create a tensor that uses the storage of a shared tensor.
+   */
+  static fromShared({buffer, byteOffset, byteLength, dtype, shape, dimOrder, strides}: SharedTensor): Tensor {
+    const data = new Uint8Array(buffer, byteOffset, byteLength);
+    return new Tensor(data, dtype, {shape, dimOrder, strides});
+  }
+
+  /**
+   * Whether the tensor's data is stored in a SharedArrayBuffer.
+   */
+  get isShared(): boolean {
+    return typeof SharedArrayBuffer != 'undefined' &&
+           this.data.buffer instanceof SharedArrayBuffer;
+  }
+
+  /**
+   * Return the tensor as a `SharedTensor` that can be posted to other workers.
+   *
+   * @remarks
+   *
+   * When the tensor is not stored in a SharedArrayBuffer, its data is copied
+   * into a new one.
+   */
+  share(): SharedTensor {
+    if (this.disposed)
+      throw new Error('The tensor has been disposed.');
+    let data = this.data;
+    if (!this.isShared) {
+      data = new Uint8Array(new SharedArrayBuffer(this.data.byteLength));
+      data.set(this.data);
+    }
+    return {
+      buffer: data.buffer as SharedArrayBuffer,
+      byteOffset: data.byteOffset,
+      byteLength: data.byteLength,
+      dtype: this.dtype,
+      shape: this.shape,
+      dimOrder: this.dimOrder,
+      strides: this.strides,
+    };
+  }
+
   /**
    * Return the tensor as a scalar.
    */
@@ -88,15 +189,70 @@ export class Tensor {
    * Return the tensor as a scalar or (nested) Array.
    */
   tolist(): Nested<number | boolean> {
-    return this.holder.tolist();
+    if (this.ndim == 0)
+      return this.item();
+    // Read elements in one native call and build the rows in JS, which is much
+    // faster than creating each element with N-API.
+    const flat = this.holder.toTypedArray(getListDType(this.dtype));
+    const steps = this.shape.map((_, i) => getSizeFromShape(this.shape.slice(i + 1)));
+    const isBool = this.dtype == DType.Bool;
+    const toRows = (dim: number, offset: number): Nested<number | boolean>[] => {
+      const length = this.shape[dim];
+      if (dim == this.ndim - 1) {
+        const row = flat.subarray(offset, offset + length) as Exclude<TypedArray, BigInt64Array | BigUint64Array>;
+        return isBool ? Array.from(row, Boolean) : Array.from(row);
+      }
+      return Array.from({length}, (_, i) => toRows(dim + 1, offset + i * steps[dim]));
+    };
+    return toRows(0, 0);
   }
 
   /**
-   * Return a TypedArray view of tensor's data.
+   * Return a TypedArray of tensor's elements in the order of shape.
+   *
+   * @remarks
+   *
+   * When the elements are contiguous and no conversion is needed, the result is
+   * a view of tensor's data, otherwise the elements are copied.
+   *
+   * @param options.dtype - The dtype of returned elements, default is tensor's
+   * own dtype, or Float32 for Float16 and BFloat16 tensors.
    */
-  toTypedArray() {
-    const arrayType = getTypedArrayFromDType(this.dtype);
-    return new arrayType(this.data.buffer);
+  toTypedArray({dtype}: {dtype?: DType} = {}): TypedArray {
+    dtype ??= getArrayDType(this.dtype);
+    if (dtype == this.dtype &&
+        !this.disposed &&
+        this.data.byteOffset % this.itemsize == 0 &&
+        isContiguous(this.shape, this.strides)) {
+      const arrayType = getTypedArrayFromDType(dtype);
+      return new arrayType(this.data.buffer, this.data.byteOffset, this.size);
+    }
+    return this.holder.toTypedArray(dtype);
+  }
+
+  /**
+   * Return the elements as a Float32Array, converting them when needed.
+   */
+  toFloat32Array(): Float32Array {
+    return this.toTypedArray({dtype: DType.Float32}) as Float32Array;
+  }
+
+  /**
+   * Free the native storage of the tensor immediately instead of waiting for
+   * GC, the tensor and its data can not be used after disposed. Throws when
+   * the tensor is used by an execution that has not finished.
+   */
+  dispose() {
+    if (tensorUses.has(this))
+      throw new Error('The tensor is in use by an execution.');
+    this.holder.dispose(this.data);
+  }
+
+  /**
+   * Whether the tensor has been disposed.
+   */
+  get disposed(): boolean {
+    return this.holder.disposed;
   }
 
   /**
@@ -142,6 +298,28 @@ export class Tensor {
   }
 }
 
+// Number of unfinished native tasks using each tensor.
+const tensorUses = new WeakMap<Tensor, number>();
+
+// Mark the tensors in |values| as in use until the native task's |promise|
+// settles, so they can not be disposed while the task reads or writes them.
+export function useTensorsUntil<T>(values: unknown[], promise: Promise<T>): Promise<T> {
+  const tensors = values.filter(v => v instanceof Tensor);
+  if (tensors.length == 0)
+    return promise;
+  for (const tensor of tensors)
+    tensorUses.set(tensor, (tensorUses.get(tensor) ?? 0) + 1);
+  return promise.finally(() => {
+    for (const tensor of tensors) {
+      const uses = tensorUses.get(tensor)! - 1;
+      if (uses > 0)
+        tensorUses.set(tensor, uses);
+      else
+        tensorUses.delete(tensor);
+    }
+  });
+}
+
 function getSizeFromShape(shape: number[]) {
   return shape.length > 0 ? shape.reduce((a, b) => a * b) : 1;
 }
@@ -172,12 +350,67 @@ function getInputShape(input: Nested<boolean | number>): number[] {
   return shape.concat(subShape);
 }
 
+function isContiguous(shape: number[], strides: number[]) {
+  let expected = 1;
+  for (let i = shape.length - 1; i >= 0; --i) {
+    if (shape[i] != 1 && strides[i] != expected)
+      return false;
+    expected *= shape[i];
+  }
+  return true;
+}
+
+// The dtype of elements returned by toTypedArray by default.
+function getArrayDType(dtype: DType) {
+  switch (dtype) {
+    case DType.Float16  :
+    case DType.BFloat16 : return DType.Float32;
+    default: return dtype;
+  }
+}
+
+// The dtype of elements used for building the rows of tolist.
+function getListDType(dtype: DType) {
+  switch (dtype) {
+    case DType.Int64 : return DType.Float64;
+    case DType.Bool  : return DType.Uint8;
+    default: return getArrayDType(dtype);
+  }
+}
+
+function getTypedArrayDType(array: ArrayBufferView): DType | undefined {
+  if (array instanceof Uint8Array || array instanceof Uint8ClampedArray)
+    return DType.Uint8;
+  if (array instanceof Int8Array)
+    return DType.Int8;
+  if (array instanceof Int16Array)
+    return DType.Int16;
+  if (array instanceof Int32Array)
+    return DType.Int32;
+  if (array instanceof BigInt64Array)
+    return DType.Int64;
+  if (array instanceof Float32Array)
+    return DType.Float32;
+  if (array instanceof Float64Array)
+    return DType.Float64;
+  if (isFloat16Array(array))
+    return DType.Float16;
+  return undefined;
+}
+
+function isFloat16Array(array: ArrayBufferView) {
+  // Float16Array is only available in recent versions of Node.js.
+  const Float16Array = (globalThis as any).Float16Array;
+  return Float16Array !== undefined && array instanceof Float16Array;
+}
+
 function getTypedArrayFromDType(dtype: DType) {
   switch (dtype) {
     case DType.Uint8   : return Uint8Array;
     case DType.Int8    : return Int8Array;
     case DType.Int16   : return Int16Array;
     case DType.Int32   : return Int32Array;
+    case DType.Int64   : return BigInt64Array;
     case DType.Float32 : return Float32Array;
     case DType.Float64 : return Float64Array;
     case DType.Bool    : return Uint8Array;
@@ -0,0 +1,102 @@
+#include "src/affinity.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace etjs {
+
+#if defined(__linux__)
+
+namespace {
+
+// Read when the addon is loaded, before any thread is bound.
+cpu_set_t GetInitialAffinity() {
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+    CPU_ZERO(&set);
+    for (long i = 0; i < sysconf(_SC_NPROCESSORS_CONF) && i < CPU_SETSIZE; ++i)
+      CPU_SET(i, &set);
+  }
+  return set;
+}
+
+const cpu_set_t g_initial_affinity = GetInitialAffinity();
+
+}  // namespace
+
+bool IsThreadAffinitySupported() {
+  return true;
+}
+
+bool IsCpuAllowed(uint32_t cpu) {
+  return cpu < CPU_SETSIZE && CPU_ISSET(cpu, &g_initial_affinity);
+}
+
+bool SetCurrentThreadAffinity(const std::vector<uint32_t>& cpus) {
+  cpu_set_t set = g_initial_affinity;
+  if (!cpus.empty()) {
+    CPU_ZERO(&set);
+    for (uint32_t cpu : cpus) {
+      if (cpu >= CPU_SETSIZE)
+        return false;
+      CPU_SET(cpu, &set);
+    }
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#elif defined(_WIN32)
+
+bool IsThreadAffinitySupported() {
+  return true;
+}
+
+bool IsCpuAllowed(uint32_t cpu) {
+  DWORD_PTR mask, system_mask;
+  if (cpu >= sizeof(DWORD_PTR) * 8 ||
+      !GetProcessAffinityMask(GetCurrentProcess(), &mask, &system_mask)) {
+    return false;
+  }
+  return (mask & (static_cast<DWORD_PTR>(1) << cpu)) != 0;
+}
+
+bool SetCurrentThreadAffinity(const std::vector<uint32_t>& cpus) {
+  DWORD_PTR mask = 0;
+  if (cpus.empty()) {
+    DWORD_PTR system_mask;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &mask, &system_mask))
+      return false;
+  } else {
+    // Only the CPUs of the first processor group are supported.
+    for (uint32_t cpu : cpus) {
+      if (cpu >= sizeof(DWORD_PTR) * 8)
+        return false;
+      mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+  }
+  return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+
+#else
+
+// macOS only supports affinity tags as scheduling hints.
+bool IsThreadAffinitySupported() {
+  return false;
+}
+
+bool IsCpuAllowed(uint32_t) {
+  return false;
+}
+
+bool SetCurrentThreadAffinity(const std::vector<uint32_t>&) {
+  return false;
+}
+
+#endif
+
+}  // namespace etjs
@@ -0,0 +1,22 @@
+#ifndef SRC_AFFINITY_H_
+#define SRC_AFFINITY_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace etjs {
+
+// Return whether threads can be bound to CPUs on this platform.
+bool IsThreadAffinitySupported();
+
+// Return whether the process is allowed to run on |cpu|, CPU ids may not be
+// contiguous.
+bool IsCpuAllowed(uint32_t cpu);
+
+// Bind the current thread to |cpus|, or to all the CPUs the process is allowed
+// to run on when |cpus| is empty.
+bool SetCurrentThreadAffinity(const std::vector<uint32_t>& cpus);
+
+}  // namespace etjs
+
+#endif  // SRC_AFFINITY_H_
@@ -0,0 +1,363 @@
+#include "src/batcher.h"
+
+#include <executorch/runtime/executor/method.h>
+#define FMT_HEADER_ONLY
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "src/cancel.h"
+#include "src/error.h"
+#include "src/module.h"
+#include "src/tensor.h"
+
+namespace etjs {
+
+struct Batcher::Request {
+  std::vector<ea::Tensor> inputs;
+  size_t batch_size;
+  std::shared_ptr<CancelState> cancel;
+  napi_deferred deferred;
+  // When the request must be run.
+  std::chrono::steady_clock::time_point deadline;
+  // The results.
+  std::string error;
+  std::vector<std::unique_ptr<Tensor>> outputs;
+};
+
+struct Batcher::Batch {
+  std::vector<std::unique_ptr<Request>> requests;
+  // Number of items in the requests.
+  size_t total = 0;
+  // Whether RunBatch has been called.
+  bool ran = false;
+  // Requests cancelled before running.
+  std::vector<std::unique_ptr<Request>> dropped;
+};
+
+namespace {
+
+bool IsContiguous(const ea::Tensor& tensor) {
+  auto dim_order = tensor.dim_order();
+  for (size_t i = 0; i < dim_order.size(); ++i) {
+    if (dim_order[i] != i)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+Batcher::Batcher(Module* mod,
+                 std::string name,
+                 std::vector<InputSpec> specs,
+                 size_t max_batch_size,
+                 std::chrono::microseconds max_wait)
+    : mod_(mod),
+      name_(std::move(name)),
+      specs_(std::move(specs)),
+      max_batch_size_(max_batch_size),
+      max_wait_(max_wait) {}
+
+Batcher::~Batcher() {
+  if (!timer_)
+    return;
+  uv_close(reinterpret_cast<uv_handle_t*>(timer_), [](uv_handle_t* handle) {
+    delete reinterpret_cast<uv_timer_t*>(handle);
+  });
+  napi_async_destroy(env_, async_context_);
+}
+
+napi_value Batcher::Execute(napi_env env,
+                            std::vector<ea::Tensor> inputs,
+                            std::shared_ptr<CancelState> cancel) {
+  napi_value result;
+  napi_deferred deferred;
+  if (napi_create_promise(env, &deferred, &result) != napi_ok) {
+    ki::ThrowError(env, "Failed to create promise");
+    return nullptr;
+  }
+  auto reject = [env, deferred, result](const std::string& message) {
+    napi_value error;
+    napi_create_error(env, nullptr, ki::ToNodeValue(env, message), &error);
+    napi_reject_deferred(env, deferred, error);
+    return result;
+  };
+  if (inputs.size() != specs_.size()) {
+    return reject(fmt::format("Expect {} arg(s) but only got {}.",
+                              specs_.size(), inputs.size()));
+  }
+  // All inputs must have the same batch size, and same shape with the method's
+  // inputs except for the batch dimension.
+  size_t batch_size = 0;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const ea::Tensor& tensor = inputs[i];
+    const InputSpec& spec = specs_[i];
+    bool valid = tensor.scalar_type() == spec.dtype &&
+                 static_cast<size_t>(tensor.dim()) == spec.sizes.size() &&
+                 IsContiguous(tensor);
+    for (size_t d = 1; valid && d < spec.sizes.size(); ++d)
+      valid = tensor.size(d) == spec.sizes[d];
+    if (valid) {
+      size_t size = tensor.size(0);
+      valid = size > 0 &&
+              size <= max_batch_size_ &&
+              (i == 0 || size == batch_size);
+      batch_size = size;
+    }
+    if (!valid)
+      return reject(fmt::format("Argument {} does not match method's input.",
+                                i));
+  }
+  if (!timer_) {
+    uv_loop_t* loop;
+    if (napi_get_uv_event_loop(env, &loop) != napi_ok ||
+        napi_async_init(env, nullptr, ki::ToNodeValue(env, "Batcher"),
+                        &async_context_) != napi_ok) {
+      return reject("Failed to create timer.");
+    }
+    env_ = env;
+    timer_ = new uv_timer_t;
+    uv_timer_init(loop, timer_);
+    timer_->data = this;
+  }
+  auto request = std::make_unique<Request>();
+  request->inputs = std::move(inputs);
+  request->batch_size = batch_size;
+  request->cancel = std::move(cancel);
+  request->deferred = deferred;
+  request->deadline = std::chrono::steady_clock::now() + max_wait_;
+  queued_items_ += batch_size;
+  requests_.push_back(std::move(request));
+  Flush(env);
+  return result;
+}
+
+Batcher::Stats Batcher::GetStats() const {
+  Stats stats;
+  stats.batches = batches_;
+  stats.requests = requests_count_;
+  stats.items = items_;
+  stats.fill_ratio = stats.batches > 0 ?
+      static_cast<double>(stats.items) / (stats.batches * max_batch_size_) : 0;
+  return stats;
+}
+
+void Batcher::ResetStats() {
+  batches_ = 0;
+  requests_count_ = 0;
+  items_ = 0;
+}
+
+void Batcher::Flush(napi_env env) {
+  auto now = std::chrono::steady_clock::now();
+  while (!requests_.empty() &&
+         (queued_items_ >= max_batch_size_ ||
+          requests_.front()->deadline <= now)) {
+    auto batch = std::make_shared<Batch>();
+    while (!requests_.empty() &&
+           (batch->total == 0 ||
+            batch->total + requests_.front()->batch_size <= max_batch_size_)) {
+      std::unique_ptr<Request> request = std::move(requests_.front());
+      requests_.pop_front();
+      queued_items_ -= request->batch_size;
+      request->error = CheckCancel(request->cancel.get());
+      if (!request->error.empty()) {
+        batch->dropped.push_back(std::move(request));
+        continue;
+      }
+      batch->total += request->batch_size;
+      batch->requests.push_back(std::move(request));
+    }
+    PostBatch(env, std::move(batch));
+  }
+  // Wake up when the first request left has waited enough.
+  if (requests_.empty()) {
+    uv_timer_stop(timer_);
+    return;
+  }
+  auto delay = std::chrono::ceil<std::chrono::milliseconds>(
+      requests_.front()->deadline - now);
+  uv_timer_start(timer_, &Batcher::OnTimer, delay.count(), 0);
+}
+
+void Batcher::PostBatch(napi_env env, std::shared_ptr<Batch> batch) {
+  if (batch->requests.empty()) {
+    ResolveBatch(env, batch.get());
+    return;
+  }
+  std::shared_ptr<Replica> replica = mod_->PickReplica();
+  if (replica && replica->queue()->Post(
+      env,
+      [this, replica, batch]() {
+        RunBatch(replica.get(), batch.get());
+      },
+      // The module owns this batcher, and is kept alive until the reply.
+      [this, mod = mod_->shared_from_this(), batch](napi_env env) {
+        // The batch is dropped when the queue is destroyed before running it.
+        if (!batch->ran) {
+          for (auto& request : batch->requests)
+            request->error = "Module has been closed.";
+        }
+        ResolveBatch(env, batch.get());
+      })) {
+    return;
+  }
+  for (auto& request : batch->requests)
+    request->error = "Failed to queue work.";
+  ResolveBatch(env, batch.get());
+}
+
+void Batcher::RunBatch(Replica* replica, Batch* batch) {
+  batch->ran = true;
+  // Drop the requests cancelled while the batch waited in queue.
+  auto cancelled = std::stable_partition(
+      batch->requests.begin(), batch->requests.end(),
+      [](const std::unique_ptr<Request>& request) {
+        request->error = CheckCancel(request->cancel.get());
+        return request->error.empty();
+      });
+  for (auto it = cancelled; it != batch->requests.end(); ++it) {
+    batch->total -= (*it)->batch_size;
+    batch->dropped.push_back(std::move(*it));
+  }
+  batch->requests.erase(cancelled, batch->requests.end());
+  if (batch->requests.empty())
+    return;
+  size_t total = batch->total;
+  // Concatenate inputs along the first dimension, there is no need to copy
+  // when there is only one request.
+  std::vector<std::unique_ptr<Tensor>> batched_inputs;
+  std::vector<er::EValue> inputs;
+  for (size_t i = 0; i < specs_.size(); ++i) {
+    if (batch->requests.size() == 1) {
+      inputs.emplace_back(batch->requests[0]->inputs[i]);
+      continue;
+    }
+    size_t nbytes = 0;
+    for (const auto& request : batch->requests)
+      nbytes += request->inputs[i].nbytes();
+    PooledBuffer data(nbytes);
+    uint8_t* dst = data.data();
+    for (const auto& request : batch->requests) {
+      const ea::Tensor& tensor = request->inputs[i];
+      std::memcpy(dst, tensor.const_data_ptr(), tensor.nbytes());
+      dst += tensor.nbytes();
+    }
+    std::vector<ea::SizesType> shape = specs_[i].sizes;
+    shape[0] = total;
+    auto tensor = std::make_unique<Tensor>(std::move(data),
+                                           specs_[i].dtype,
+                                           std::move(shape));
+    inputs.emplace_back(ea::Tensor(tensor->impl()));
+    batched_inputs.push_back(std::move(tensor));
+  }
+  // Execute and split outputs, the lock must be held until outputs are copied.
+  std::string error;
+  {
+    std::lock_guard lock(replica->mutex());
+    auto method = replica->GetMethod(name_);
+    if (!method.ok())
+      error = ErrorCodeToMessage(method.error());
+    auto outputs = error.empty() ? replica->Execute(*method, inputs)
+                                 : er::Result<std::vector<er::EValue>>(
+                                       method.error());
+    if (error.empty() && !outputs.ok())
+      error = ErrorCodeToMessage(outputs.error());
+    for (size_t o = 0; error.empty() && o < outputs->size(); ++o) {
+      const er::EValue& output = outputs->at(o);
+      if (!output.isTensor() ||
+          output.toTensor().dim() == 0 ||
+          static_cast<size_t>(output.toTensor().size(0)) != total ||
+          !IsContiguous(output.toTensor())) {
+        error = fmt::format("Output {} does not have batch dimension.", o);
+        break;
+      }
+      const ea::Tensor& tensor = output.toTensor();
+      size_t item_nbytes = tensor.nbytes() / total;
+      auto* src = static_cast<const uint8_t*>(tensor.const_data_ptr());
+      for (auto& request : batch->requests) {
+        std::vector<ea::SizesType> shape(tensor.sizes().begin(),
+                                         tensor.sizes().end());
+        shape[0] = request->batch_size;
+        size_t nbytes = request->batch_size * item_nbytes;
+        PooledBuffer data(nbytes);
+        std::memcpy(data.data(), src, nbytes);
+        request->outputs.push_back(std::make_unique<Tensor>(
+            std::move(data),
+            tensor.scalar_type(),
+            std::move(shape)));
+        src += nbytes;
+      }
+    }
+  }
+  if (!error.empty()) {
+    for (auto& request : batch->requests) {
+      request->error = error;
+      request->outputs.clear();
+    }
+  }
+  batches_++;
+  requests_count_ += batch->requests.size();
+  items_ += total;
+}
+
+void Batcher::ResolveBatch(napi_env env, Batch* batch) {
+  for (auto& request : batch->dropped)
+    batch->requests.push_back(std::move(request));
+  for (auto& request : batch->requests) {
+    if (!request->error.empty()) {
+      napi_value error;
+      napi_create_error(env, nullptr, ki::ToNodeValue(env, request->error),
+                        &error);
+      napi_reject_deferred(env, request->deferred, error);
+      continue;
+    }
+    napi_value outputs;
+    napi_create_array_with_length(env, request->outputs.size(), &outputs);
+    for (size_t i = 0; i < request->outputs.size(); ++i) {
+      napi_set_element(env, outputs, i,
+                       ki::ToNodeValue(env, request->outputs[i].release()));
+    }
+    napi_resolve_deferred(env, request->deferred, outputs);
+  }
+}
+
+// static
+void Batcher::OnTimer(uv_timer_t* timer) {
+  auto* self = static_cast<Batcher*>(timer->data);
+  napi_env env = self->env_;
+  // Promises may be settled in the flush, so run it in a callback scope for
+  // the microtasks to run after it.
+  napi_handle_scope handle_scope;
+  napi_open_handle_scope(env, &handle_scope);
+  napi_value resource;
+  napi_create_object(env, &resource);
+  napi_callback_scope callback_scope;
+  napi_open_callback_scope(env, resource, self->async_context_,
+                           &callback_scope);
+  self->Flush(env);
+  napi_close_callback_scope(env, callback_scope);
+  napi_close_handle_scope(env, handle_scope);
+}
+
+}  // namespace etjs
+
+namespace ki {
+
+// static
+napi_status Type<etjs::Batcher::Stats>::ToNode(
+    napi_env env,
+    const etjs::Batcher::Stats& value,
+    napi_value* result) {
+  *result = CreateObject(env);
+  Set(env, *result,
+      "batches", static_cast<double>(value.batches),
+      "requests", static_cast<double>(value.requests),
+      "items", static_cast<double>(value.items),
+      "fillRatio", value.fill_ratio);
+  return napi_ok;
+}
+
+}  // namespace ki
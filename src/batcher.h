@@ -0,0 +1,116 @@
+#ifndef SRC_BATCHER_H_
+#define SRC_BATCHER_H_
+
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <kizunapi.h>
+
+#include <uv.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ea = executorch::aten;
+namespace er = executorch::runtime;
+
+namespace etjs {
+
+class CancelState;
+class Module;
+class Replica;
+class Tensor;
+
+// Collect concurrent executions of a method whose inputs and outputs are all
+// tensors with a batch dimension, and run them in one batch. Requests are
+// queued on JS thread, and a batch is posted to a replica when it is full or
+// when its first request has waited enough.
+class Batcher {
+ public:
+  // Expected dtype and shape of an input, the first dim is the max batch size.
+  struct InputSpec {
+    ea::ScalarType dtype;
+    std::vector<ea::SizesType> sizes;
+  };
+
+  struct Stats {
+    uint64_t batches;
+    uint64_t requests;
+    uint64_t items;
+    double fill_ratio;
+  };
+
+  Batcher(Module* mod,
+          std::string name,
+          std::vector<InputSpec> specs,
+          size_t max_batch_size,
+          std::chrono::microseconds max_wait);
+  ~Batcher();
+
+  Batcher& operator=(const Batcher&) = delete;
+  Batcher(const Batcher&) = delete;
+
+  // Queue the inputs and return a Promise that resolves with the outputs, or
+  // rejects when the inputs do not match. The request is dropped if |cancel|
+  // is cancelled before it runs. Must be called on JS thread.
+  napi_value Execute(napi_env env,
+                     std::vector<ea::Tensor> inputs,
+                     std::shared_ptr<CancelState> cancel);
+
+  Stats GetStats() const;
+  void ResetStats();
+
+ private:
+  struct Request;
+  struct Batch;
+
+  // Post batches that are full or have waited enough, and wait for the rest
+  // with the timer.
+  void Flush(napi_env env);
+  // Post the batch to a replica.
+  void PostBatch(napi_env env, std::shared_ptr<Batch> batch);
+  // Run the batch on worker thread.
+  void RunBatch(Replica* replica, Batch* batch);
+  // Resolve promises of the batch on JS thread.
+  void ResolveBatch(napi_env env, Batch* batch);
+
+  static void OnTimer(uv_timer_t* timer);
+
+  Module* mod_;
+  const std::string name_;
+  const std::vector<InputSpec> specs_;
+  const size_t max_batch_size_;
+  const std::chrono::microseconds max_wait_;
+
+  // Only accessed on JS thread.
+  std::deque<std::unique_ptr<Request>> requests_;
+  // Number of items in queued requests.
+  size_t queued_items_ = 0;
+  // Created on first request, and fired when the first queued request must be
+  // run.
+  napi_env env_ = nullptr;
+  uv_timer_t* timer_ = nullptr;
+  napi_async_context async_context_ = nullptr;
+
+  std::atomic<uint64_t> batches_ = 0;
+  std::atomic<uint64_t> requests_count_ = 0;
+  std::atomic<uint64_t> items_ = 0;
+};
+
+}  // namespace etjs
+
+namespace ki {
+
+template<>
+struct Type<etjs::Batcher::Stats> {
+  static constexpr const char* name = "BatcherStats";
+  static napi_status ToNode(napi_env env,
+                            const etjs::Batcher::Stats& value,
+                            napi_value* result);
+};
+
+}  // namespace ki
+
+#endif  // SRC_BATCHER_H_
@@ -1,10 +1,16 @@
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
 #include <executorch/runtime/platform/runtime.h>
 
+#include "src/buffer_pool.h"
+#include "src/cancel.h"
 #include "src/evalue.h"
+#include "src/intra_op.h"
 #include "src/module.h"
+#include "src/prepared_method.h"
+#include "src/random.h"
 #include "src/sample.h"
 #include "src/scalar.h"
+#include "src/softmax.h"
 #include "src/tensor.h"
 
 namespace er = executorch::runtime;
@@ -32,7 +38,10 @@ napi_value Init(napi_env env, napi_value exports) {
 #endif
           "cpu", true);
   ki::Set(env, exports,
-          "Module", ki::Class<ee::Module>(),
+          "CancelToken", ki::Class<etjs::CancelToken>(),
+          "Generator", ki::Class<etjs::Generator>(),
+          "Module", ki::Class<etjs::Module>(),
+          "PreparedMethod", ki::Class<etjs::PreparedMethod>(),
           "Scalar", ki::Class<ea::Scalar>(),
           "Tensor", ki::Class<etjs::Tensor>(),
           "ScalarType", etjs::CreateScalarTypeEnum(env),
@@ -44,7 +53,14 @@ napi_value Init(napi_env env, napi_value exports) {
           "config", "Release",
 #endif
           "elementSize", &er::elementSize,
-          "sample", &etjs::Sample);
+          "getBufferPoolStats", &etjs::GetBufferPoolStats,
+          "setBufferPoolLimit", &etjs::SetBufferPoolLimit,
+          "clearBufferPool", &etjs::ClearBufferPool,
+          "getIntraOpThreads", &etjs::GetIntraOpThreads,
+          "setIntraOpThreads", &etjs::SetIntraOpThreads,
+          "sample", &etjs::Sample,
+          "sampleBatch", &etjs::SampleBatch,
+          "softmaxKernel", etjs::GetSoftmaxKernelName());
   return exports;
 }
 
@@ -0,0 +1,258 @@
+#include "src/buffer_pool.h"
+
+#include <array>
+#include <bit>
+#include <new>
+
+namespace etjs {
+
+namespace {
+
+// Sizes are rounded up to classes of 4 steps between powers of two, so at most
+// 25% of a buffer is wasted.
+constexpr size_t kSubClasses = 4;
+constexpr size_t kMinClassSizeLog2 = 8;
+constexpr size_t kMaxClassSizeLog2 = 30;
+constexpr size_t kMaxClassSize = size_t(1) << kMaxClassSizeLog2;
+constexpr size_t kNumClasses =
+    (kMaxClassSizeLog2 - kMinClassSizeLog2) * kSubClasses + 1;
+
+// Each thread caches a few buffers of small classes.
+constexpr size_t kThreadCacheSlots = 4;
+constexpr size_t kMaxThreadCachedSize = size_t(1) << 24;
+
+constexpr size_t kDefaultMaxCachedBytes = size_t(1) << 28;
+constexpr std::align_val_t kAlignment{64};
+
+// Return the index of smallest class that fits |size|.
+size_t GetSizeClass(size_t size) {
+  if (size <= (size_t(1) << kMinClassSizeLog2))
+    return 0;
+  size_t log2 = std::bit_width(size - 1) - 1;
+  size_t base = size_t(1) << log2;
+  size_t step = base / kSubClasses;
+  return (log2 - kMinClassSizeLog2) * kSubClasses +
+         (size - base + step - 1) / step;
+}
+
+// Return the size of buffers in the class.
+size_t GetClassSize(size_t index) {
+  if (index == 0)
+    return size_t(1) << kMinClassSizeLog2;
+  size_t base = size_t(1) << ((index - 1) / kSubClasses + kMinClassSizeLog2);
+  return base + ((index - 1) % kSubClasses + 1) * (base / kSubClasses);
+}
+
+}  // namespace
+
+struct BufferPool::ThreadCache {
+  explicit ThreadCache(BufferPool* pool) : pool(pool) {
+    std::lock_guard lock(pool->mutex_);
+    pool->thread_caches_.push_back(this);
+  }
+
+  // Give the cached buffers back to pool when thread exits.
+  ~ThreadCache() {
+    std::lock_guard lock(pool->mutex_);
+    std::erase(pool->thread_caches_, this);
+    std::lock_guard cache_lock(mutex);
+    for (size_t i = 0; i < kNumClasses; ++i) {
+      for (size_t j = 0; j < counts[i]; ++j)
+        pool->free_lists_[i].push_back(slots[i][j]);
+    }
+  }
+
+  // Take a buffer of the class, or return null if there is none.
+  void* Pop(size_t index) {
+    std::lock_guard lock(mutex);
+    if (counts[index] == 0)
+      return nullptr;
+    return slots[index][--counts[index]];
+  }
+
+  // Keep the buffer, or return false if the class is full.
+  bool Push(size_t index, void* ptr) {
+    std::lock_guard lock(mutex);
+    if (counts[index] == kThreadCacheSlots)
+      return false;
+    slots[index][counts[index]++] = ptr;
+    return true;
+  }
+
+  BufferPool* pool;
+  // Only contended when the pool is being cleared from another thread. The
+  // pool's lock must be acquired first when both are held.
+  std::mutex mutex;
+  std::array<std::array<void*, kThreadCacheSlots>, kNumClasses> slots;
+  std::array<size_t, kNumClasses> counts = {};
+};
+
+BufferPool::BufferPool(size_t max_cached_bytes)
+    : max_cached_bytes_(max_cached_bytes), free_lists_(kNumClasses) {}
+
+BufferPool::~BufferPool() {
+  Clear();
+}
+
+// static
+BufferPool* BufferPool::GetDefault() {
+  // Leaked so buffers can be freed during exit.
+  static BufferPool* pool = new BufferPool(kDefaultMaxCachedBytes);
+  return pool;
+}
+
+void* BufferPool::Allocate(size_t size, size_t* capacity) {
+  ++allocations_;
+  if (size > kMaxClassSize) {
+    *capacity = size;
+    in_use_bytes_ += size;
+    return ::operator new(size, kAlignment);
+  }
+  size_t index = GetSizeClass(size);
+  *capacity = GetClassSize(index);
+  in_use_bytes_ += *capacity;
+  void* ptr = nullptr;
+  if (ThreadCache* cache = GetThreadCache(); cache)
+    ptr = cache->Pop(index);
+  if (!ptr) {
+    std::lock_guard lock(mutex_);
+    if (!free_lists_[index].empty()) {
+      ptr = free_lists_[index].back();
+      free_lists_[index].pop_back();
+    }
+  }
+  if (!ptr)
+    return ::operator new(*capacity, kAlignment);
+  ++reuses_;
+  cached_bytes_ -= *capacity;
+  return ptr;
+}
+
+void BufferPool::Free(void* ptr, size_t capacity) {
+  in_use_bytes_ -= capacity;
+  if (capacity > kMaxClassSize || !ReserveCachedBytes(capacity)) {
+    ::operator delete(ptr, kAlignment);
+    return;
+  }
+  size_t index = GetSizeClass(capacity);
+  ThreadCache* cache = GetThreadCache();
+  if (cache && capacity <= kMaxThreadCachedSize && cache->Push(index, ptr))
+    return;
+  std::lock_guard lock(mutex_);
+  free_lists_[index].push_back(ptr);
+}
+
+void BufferPool::SetMaxCachedBytes(size_t max_cached_bytes) {
+  max_cached_bytes_ = max_cached_bytes;
+  if (cached_bytes_ > max_cached_bytes)
+    Clear();
+}
+
+void BufferPool::Clear() {
+  std::vector<std::vector<void*>> free_lists(kNumClasses);
+  {
+    std::lock_guard lock(mutex_);
+    free_lists.swap(free_lists_);
+    // Also take the buffers cached by every thread, including the idle ones.
+    for (ThreadCache* cache : thread_caches_) {
+      std::lock_guard cache_lock(cache->mutex);
+      for (size_t i = 0; i < kNumClasses; ++i) {
+        for (size_t j = 0; j < cache->counts[i]; ++j)
+          free_lists[i].push_back(cache->slots[i][j]);
+        cache->counts[i] = 0;
+      }
+    }
+  }
+  for (size_t i = 0; i < kNumClasses; ++i) {
+    for (void* ptr : free_lists[i]) {
+      cached_bytes_ -= GetClassSize(i);
+      ::operator delete(ptr, kAlignment);
+    }
+  }
+}
+
+BufferPool::Stats BufferPool::GetStats() const {
+  return {allocations_, reuses_, in_use_bytes_, cached_bytes_,
+          max_cached_bytes_};
+}
+
+bool BufferPool::ReserveCachedBytes(size_t size) {
+  size_t cached = cached_bytes_.load(std::memory_order_relaxed);
+  do {
+    if (cached + size > max_cached_bytes_)
+      return false;
+  } while (!cached_bytes_.compare_exchange_weak(cached, cached + size));
+  return true;
+}
+
+BufferPool::ThreadCache* BufferPool::GetThreadCache() {
+  // Only the default pool has thread caches.
+  if (this != GetDefault())
+    return nullptr;
+  thread_local ThreadCache cache(this);
+  return &cache;
+}
+
+PooledBuffer::PooledBuffer() = default;
+
+PooledBuffer::PooledBuffer(size_t size) : size_(size) {
+  data_ = static_cast<uint8_t*>(
+      BufferPool::GetDefault()->Allocate(size, &capacity_));
+}
+
+PooledBuffer::~PooledBuffer() {
+  if (data_)
+    BufferPool::GetDefault()->Free(data_, capacity_);
+}
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other)
+    : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+  other.data_ = nullptr;
+  other.size_ = other.capacity_ = 0;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) {
+  if (this != &other) {
+    if (data_)
+      BufferPool::GetDefault()->Free(data_, capacity_);
+    data_ = other.data_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    other.data_ = nullptr;
+    other.size_ = other.capacity_ = 0;
+  }
+  return *this;
+}
+
+BufferPool::Stats GetBufferPoolStats() {
+  return BufferPool::GetDefault()->GetStats();
+}
+
+void SetBufferPoolLimit(double max_cached_bytes) {
+  BufferPool::GetDefault()->SetMaxCachedBytes(max_cached_bytes);
+}
+
+void ClearBufferPool() {
+  BufferPool::GetDefault()->Clear();
+}
+
+}  // namespace etjs
+
+namespace ki {
+
+// static
+napi_status Type<etjs::BufferPool::Stats>::ToNode(
+    napi_env env,
+    const etjs::BufferPool::Stats& value,
+    napi_value* result) {
+  *result = CreateObject(env);
+  Set(env, *result,
+      "allocations", static_cast<double>(value.allocations),
+      "reuses", static_cast<double>(value.reuses),
+      "inUseBytes", static_cast<double>(value.in_use_bytes),
+      "cachedBytes", static_cast<double>(value.cached_bytes),
+      "maxCachedBytes", static_cast<double>(value.max_cached_bytes));
+  return napi_ok;
+}
+
+}  // namespace ki
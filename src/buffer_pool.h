@@ -0,0 +1,104 @@
+#ifndef SRC_BUFFER_POOL_H_
+#define SRC_BUFFER_POOL_H_
+
+#include <kizunapi.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace etjs {
+
+// Cache freed buffers in size classes so tensors of repeated shapes reuse the
+// same memory. Each thread keeps a few buffers of every class to avoid sharing
+// the pool's lock.
+class BufferPool {
+ public:
+  struct Stats {
+    uint64_t allocations;
+    // Number of allocations served by cached buffers.
+    uint64_t reuses;
+    size_t in_use_bytes;
+    size_t cached_bytes;
+    size_t max_cached_bytes;
+  };
+
+  explicit BufferPool(size_t max_cached_bytes);
+  ~BufferPool();
+
+  BufferPool& operator=(const BufferPool&) = delete;
+  BufferPool(const BufferPool&) = delete;
+
+  // The pool used by tensors.
+  static BufferPool* GetDefault();
+
+  // Return a buffer of at least |size| bytes, the real size is written to
+  // |capacity| which must be passed to Free.
+  void* Allocate(size_t size, size_t* capacity);
+  void Free(void* ptr, size_t capacity);
+
+  // Set the max bytes of cached buffers, buffers freed beyond it are returned
+  // to system.
+  void SetMaxCachedBytes(size_t max_cached_bytes);
+  // Release the buffers cached by the pool and all threads.
+  void Clear();
+
+  Stats GetStats() const;
+
+ private:
+  struct ThreadCache;
+
+  // Add |size| to the cached bytes if it stays within the limit.
+  bool ReserveCachedBytes(size_t size);
+  ThreadCache* GetThreadCache();
+
+  std::atomic<uint64_t> allocations_ = 0;
+  std::atomic<uint64_t> reuses_ = 0;
+  std::atomic<size_t> in_use_bytes_ = 0;
+  std::atomic<size_t> cached_bytes_ = 0;
+  std::atomic<size_t> max_cached_bytes_;
+
+  std::mutex mutex_;
+  std::vector<std::vector<void*>> free_lists_;
+  std::vector<ThreadCache*> thread_caches_;
+};
+
+// Buffer allocated from the pool and returned to it on destruction.
+class PooledBuffer {
+ public:
+  PooledBuffer();
+  explicit PooledBuffer(size_t size);
+  ~PooledBuffer();
+
+  PooledBuffer(PooledBuffer&& other);
+  PooledBuffer& operator=(PooledBuffer&& other);
+
+  uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+// Functions for accessing the default pool from JS.
+BufferPool::Stats GetBufferPoolStats();
+void SetBufferPoolLimit(double max_cached_bytes);
+void ClearBufferPool();
+
+}  // namespace etjs
+
+namespace ki {
+
+template<>
+struct Type<etjs::BufferPool::Stats> {
+  static constexpr const char* name = "BufferPoolStats";
+  static napi_status ToNode(napi_env env,
+                            const etjs::BufferPool::Stats& value,
+                            napi_value* result);
+};
+
+}  // namespace ki
+
+#endif  // SRC_BUFFER_POOL_H_
@@ -0,0 +1,69 @@
+#include "src/cancel.h"
+
+namespace etjs {
+
+CancelState::CancelState(std::optional<double> timeout_ms) {
+  if (timeout_ms) {
+    deadline_ = std::chrono::steady_clock::now() +
+                std::chrono::microseconds(
+                    static_cast<int64_t>(*timeout_ms * 1000));
+  }
+}
+
+CancelState::~CancelState() = default;
+
+std::string CancelState::Check() const {
+  if (cancelled_)
+    return "The operation was aborted.";
+  if (deadline_ && std::chrono::steady_clock::now() >= *deadline_)
+    return "The operation has timed out.";
+  return std::string();
+}
+
+std::string CheckCancel(const CancelState* state) {
+  return state ? state->Check() : std::string();
+}
+
+CancelToken::CancelToken(std::optional<double> timeout_ms)
+    : state_(std::make_shared<CancelState>(timeout_ms)) {}
+
+CancelToken::~CancelToken() = default;
+
+}  // namespace etjs
+
+namespace ki {
+
+// static
+void Type<etjs::CancelToken>::Define(napi_env env,
+                                     napi_value,
+                                     napi_value prototype) {
+  Set(env, prototype, "cancel", &etjs::CancelToken::Cancel);
+}
+
+// static
+etjs::CancelToken* Type<etjs::CancelToken>::Constructor(
+    std::optional<double> timeout_ms) {
+  return new etjs::CancelToken(timeout_ms);
+}
+
+// static
+void Type<etjs::CancelToken>::Destructor(etjs::CancelToken* ptr) {
+  delete ptr;
+}
+
+// static
+std::optional<std::shared_ptr<etjs::CancelState>>
+Type<std::shared_ptr<etjs::CancelState>>::FromNode(napi_env env,
+                                                   napi_value value) {
+  napi_valuetype type;
+  if (napi_typeof(env, value, &type) != napi_ok)
+    return std::nullopt;
+  if (type == napi_undefined || type == napi_null)
+    return std::shared_ptr<etjs::CancelState>();
+  auto token = FromNodeTo<etjs::CancelToken*>(env, value);
+  if (!token)
+    return std::nullopt;
+  return (*token)->state();
+}
+
+}  // namespace ki
@@ -0,0 +1,78 @@
+#ifndef SRC_CANCEL_H_
+#define SRC_CANCEL_H_
+
+#include <kizunapi.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace etjs {
+
+// Whether a task has been aborted or has passed its deadline, shared between
+// JS and the threads running the task.
+class CancelState {
+ public:
+  explicit CancelState(std::optional<double> timeout_ms);
+  ~CancelState();
+
+  CancelState& operator=(const CancelState&) = delete;
+  CancelState(const CancelState&) = delete;
+
+  void Cancel() { cancelled_ = true; }
+
+  // Return an error message when the task should stop, otherwise empty string.
+  std::string Check() const;
+
+ private:
+  std::atomic<bool> cancelled_ = false;
+  std::optional<std::chrono::steady_clock::time_point> deadline_;
+};
+
+// Same with CancelState::Check, but also accepts null.
+std::string CheckCancel(const CancelState* state);
+
+// The cancel token exposed to JS, its state can be shared with tasks that may
+// outlive the JS object.
+class CancelToken {
+ public:
+  explicit CancelToken(std::optional<double> timeout_ms);
+  ~CancelToken();
+
+  CancelToken& operator=(const CancelToken&) = delete;
+  CancelToken(const CancelToken&) = delete;
+
+  void Cancel() { state_->Cancel(); }
+
+  const std::shared_ptr<CancelState>& state() const { return state_; }
+
+ private:
+  std::shared_ptr<CancelState> state_;
+};
+
+}  // namespace etjs
+
+namespace ki {
+
+template<>
+struct Type<etjs::CancelToken> {
+  static constexpr const char* name = "CancelToken";
+  static void Define(napi_env env, napi_value, napi_value prototype);
+  static etjs::CancelToken* Constructor(std::optional<double> timeout_ms);
+  static void Destructor(etjs::CancelToken* ptr);
+};
+
+// Convert an optional CancelToken to its state, undefined is converted to null.
+template<>
+struct Type<std::shared_ptr<etjs::CancelState>> {
+  static constexpr const char* name = "CancelToken";
+  static std::optional<std::shared_ptr<etjs::CancelState>> FromNode(
+      napi_env env,
+      napi_value value);
+};
+
+}  // namespace ki
+
+#endif  // SRC_CANCEL_H_
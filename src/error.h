@@ -2,8 +2,11 @@
 #define SRC_ERROR_H_
 
 #include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
 #include <kizunapi.h>
 
+namespace er = executorch::runtime;
+
 namespace etjs {
 
 inline const char* ErrorCodeToString(executorch::runtime::Error value) {
@@ -103,6 +106,18 @@ struct Type<er::Error> {
   }
 };
 
+template<typename T>
+struct Type<er::Result<T>> {
+  static constexpr const char* name = Type<T>::name;
+  static napi_status ToNode(napi_env env,
+                            const er::Result<T>& value,
+                            napi_value* result) {
+    if (!value.ok())
+      return ConvertToNode(env, value.error(), result);
+    return ConvertToNode(env, value.get(), result);
+  }
+};
+
 }  // namespace ki
 
 #endif  // SRC_ERROR_H_
@@ -1,4 +1,10 @@
 #include "src/evalue.h"
+
+#define FMT_HEADER_ONLY
+#include <fmt/format.h>
+
+#include <type_traits>
+
 #include "src/scalar.h"
 #include "src/tensor.h"
 
@@ -15,6 +21,90 @@ napi_value CreateTagEnum(napi_env env) {
   return obj;
 }
 
+std::string ToEValue(er::Tag tag,
+                     const EValueVariant& arg,
+                     size_t index,
+                     er::EValue* out) {
+  switch (tag) {
+    case er::Tag::Tensor:
+      if (auto* t = std::get_if<ea::Tensor>(&arg); t) {
+        *out = er::EValue(*t);
+        return std::string();
+      }
+      return fmt::format("Argument {} should be Tensor.", index);
+    case er::Tag::String:
+      if (auto* s = std::get_if<std::string>(&arg); s) {
+        *out = er::EValue(s->c_str(), s->size());
+        return std::string();
+      }
+      return fmt::format("Argument {} should be String.", index);
+    case er::Tag::Int:
+      if (auto* d = std::get_if<double>(&arg); d) {
+        *out = er::EValue(static_cast<int64_t>(*d));
+        return std::string();
+      }
+      return fmt::format("Argument {} should be interger.", index);
+    case er::Tag::Double:
+      if (auto* d = std::get_if<double>(&arg); d) {
+        *out = er::EValue(*d);
+        return std::string();
+      }
+      return fmt::format("Argument {} should be number.", index);
+    default:
+      return fmt::format("Unexpected EValue tag {}.", static_cast<int>(tag));
+  }
+}
+
+std::vector<OwnedEValue> CopyOutputs(const std::vector<er::EValue>& outputs) {
+  std::vector<OwnedEValue> result(outputs.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const er::EValue& output = outputs[i];
+    OwnedEValue::Value& value = result[i].value;
+    switch (output.tag) {
+      case er::Tag::Tensor:
+        value = Tensor::Copy(output.toTensor());
+        break;
+      case er::Tag::ListTensor: {
+        std::vector<std::unique_ptr<Tensor>> tensors;
+        for (const ea::Tensor& tensor : output.toTensorList())
+          tensors.push_back(Tensor::Copy(tensor));
+        value = std::move(tensors);
+        break;
+      }
+      case er::Tag::ListOptionalTensor: {
+        std::vector<std::unique_ptr<Tensor>> tensors;
+        for (const auto& tensor : output.toListOptionalTensor())
+          tensors.push_back(tensor ? Tensor::Copy(tensor.value()) : nullptr);
+        value = std::move(tensors);
+        break;
+      }
+      case er::Tag::String:
+        value = std::string(output.toString().data(),
+                            output.toString().size());
+        break;
+      case er::Tag::ListInt: {
+        auto list = output.toIntList();
+        value = std::vector<int64_t>(list.begin(), list.end());
+        break;
+      }
+      case er::Tag::ListDouble: {
+        auto list = output.toDoubleList();
+        value = std::vector<double>(list.begin(), list.end());
+        break;
+      }
+      case er::Tag::ListBool: {
+        auto list = output.toBoolList();
+        value = std::vector<bool>(list.begin(), list.end());
+        break;
+      }
+      default:
+        value = output;
+        break;
+    }
+  }
+  return result;
+}
+
 }  // namespace etjs
 
 namespace ki {
@@ -51,4 +141,45 @@ napi_status Type<er::EValue>::ToNode(napi_env env,
   }
 }
 
+namespace {
+
+napi_status ReleaseToNode(napi_env env,
+                          std::unique_ptr<etjs::Tensor>& tensor,
+                          napi_value* result) {
+  if (!tensor)
+    return napi_get_undefined(env, result);
+  tensor->ReportExternalMemory(env);
+  return ConvertToNode(env, tensor.release(), result);
+}
+
+}  // namespace
+
+// static
+napi_status Type<etjs::OwnedEValue>::ToNode(napi_env env,
+                                          const etjs::OwnedEValue& value,
+                                          napi_value* result) {
+  return std::visit([env, result](auto& v) -> napi_status {
+    using T = std::decay_t<decltype(v)>;
+    if constexpr (std::is_same_v<T, std::unique_ptr<etjs::Tensor>>) {
+      return ReleaseToNode(env, v, result);
+    } else if constexpr (std::is_same_v<T, std::vector<bool>> ||
+                         std::is_same_v<
+                             T, std::vector<std::unique_ptr<etjs::Tensor>>>) {
+      napi_status s = napi_create_array_with_length(env, v.size(), result);
+      for (size_t i = 0; s == napi_ok && i < v.size(); ++i) {
+        napi_value element;
+        if constexpr (std::is_same_v<T, std::vector<bool>>)
+          s = ConvertToNode(env, static_cast<bool>(v[i]), &element);
+        else
+          s = ReleaseToNode(env, v[i], &element);
+        if (s == napi_ok)
+          s = napi_set_element(env, *result, i, element);
+      }
+      return s;
+    } else {
+      return ConvertToNode(env, v, result);
+    }
+  }, value.value);
+}
+
 }  // namespace ki
@@ -5,13 +5,49 @@
 #include <executorch/runtime/core/span.h>
 #include <kizunapi.h>
 
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "src/tensor.h"
+
 namespace ea = executorch::aten;
 namespace er = executorch::runtime;
 
 namespace etjs {
 
+// According to MethodMeta::input_tag/output_tag, these are the types we only
+// need to support
+using EValueVariant = std::variant<ea::Tensor, std::string, double, bool>;
+
 napi_value CreateTagEnum(napi_env env);
 
+// Convert the |index|-th argument to an input of |tag|, return an error message
+// on failure. Strings in |out| point to the argument's storage.
+std::string ToEValue(er::Tag tag,
+                     const EValueVariant& arg,
+                     size_t index,
+                     er::EValue* out);
+
+// An output copied out of the method's memory, so it can be converted to JS
+// after other executions of the method overwrite the outputs.
+struct OwnedEValue {
+  using Value = std::variant<er::EValue,  // None, Int, Double and Bool.
+                             std::unique_ptr<Tensor>,
+                             std::vector<std::unique_ptr<Tensor>>,
+                             std::string,
+                             std::vector<int64_t>,
+                             std::vector<double>,
+                             std::vector<bool>>;
+  // The tensors are moved to JS when converted.
+  mutable Value value;
+};
+
+// Copy the |outputs| of a method, must be called while no other execution of
+// the method can run.
+std::vector<OwnedEValue> CopyOutputs(const std::vector<er::EValue>& outputs);
+
 }  // namespace etjs
 
 namespace ki {
@@ -74,6 +110,13 @@ struct Type<er::EValue> {
                             napi_value* result);
 };
 
+template<>
+struct Type<etjs::OwnedEValue> {
+  static napi_status ToNode(napi_env env,
+                            const etjs::OwnedEValue& value,
+                            napi_value* result);
+};
+
 }  // namespace ki
 
 #endif  // SRC_EVALUE_H_
@@ -0,0 +1,156 @@
+#include "src/generation.h"
+
+#include <executorch/runtime/executor/method.h>
+
+#include <algorithm>
+#include <mutex>
+
+#include "src/cancel.h"
+#include "src/error.h"
+#include "src/replica.h"
+
+namespace etjs {
+
+namespace {
+
+// Set the input of method to a Long tensor of shape [1, size] or [size] that
+// points to |data|, which must be kept alive until execution finishes.
+er::Error SetLongInput(er::Method* method,
+                       size_t index,
+                       int64_t* data,
+                       size_t ndim,
+                       size_t size) {
+  ea::SizesType sizes[2] = {1, static_cast<ea::SizesType>(size)};
+  ea::DimOrderType dim_order[2] = {0, 1};
+  ea::StridesType strides[2] = {static_cast<ea::StridesType>(size), 1};
+  size_t offset = 2 - ndim;
+  ea::TensorImpl impl(ea::ScalarType::Long,
+                      ndim,
+                      sizes + offset,
+                      data,
+                      dim_order,
+                      strides + offset,
+                      ea::TensorShapeDynamism::DYNAMIC_BOUND);
+  return method->set_input(er::EValue(ea::Tensor(&impl)), index);
+}
+
+bool IsLongTensor(const er::MethodMeta& meta, size_t index, size_t ndim) {
+  auto tag = meta.input_tag(index);
+  if (!tag.ok() || tag.get() != er::Tag::Tensor)
+    return false;
+  auto info = meta.input_tensor_meta(index);
+  return info.ok() &&
+         info->scalar_type() == ea::ScalarType::Long &&
+         info->sizes().size() == ndim;
+}
+
+// Read the "use_kv_cache" method exported with LLMs, which returns a constant.
+er::Result<bool> ReadUseKVCache(Replica* replica) {
+  auto method = replica->GetMethod("use_kv_cache");
+  if (!method.ok())
+    return method.error();
+  er::Error error = replica->Run(*method);
+  if (error != er::Error::Ok)
+    return error;
+  const er::EValue& output = (*method)->get_output(0);
+  if (output.isBool())
+    return output.toBool();
+  if (output.isInt())
+    return output.toInt() != 0;
+  return er::Error::InvalidType;
+}
+
+}  // namespace
+
+std::string Generate(Replica* replica,
+                     const std::string& name,
+                     std::vector<int64_t> tokens,
+                     const GenerationOptions& options,
+                     const std::function<void(int64_t)>& on_token) {
+  if (tokens.empty())
+    return "The prompt must not be empty.";
+  // The replica is only locked for each execution, so sync calls using it are
+  // not blocked for the whole generation. Loaded methods are never freed
+  // before the replica, so the method can be used after unlocking.
+  std::unique_lock lock(replica->mutex());
+  auto method = replica->GetMethod(name);
+  if (!method.ok())
+    return ErrorCodeToMessage(method.error());
+  bool use_kv_cache = false;
+  if (options.kv_cache) {
+    use_kv_cache = *options.kv_cache;
+  } else if (auto metadata = ReadUseKVCache(replica); metadata.ok()) {
+    use_kv_cache = *metadata;
+  }
+  // Check the signature.
+  auto meta = (*method)->method_meta();
+  if (meta.num_inputs() != (use_kv_cache ? 2 : 1) ||
+      !IsLongTensor(meta, 0, 2) ||
+      (use_kv_cache && !IsLongTensor(meta, 1, 1))) {
+    if (use_kv_cache)
+      return "The method must take Long tokens of shape [1, N] and Long "
+             "start position of shape [1].";
+    return "The method must take Long tokens of shape [1, N], set the kvCache "
+           "option if it also takes the start position.";
+  }
+  if (meta.num_outputs() < 1 || meta.output_tag(0).get() != er::Tag::Tensor)
+    return "The method must return logits.";
+  // The max number of tokens that can be passed in one execution.
+  size_t max_seq_len = meta.input_tensor_meta(0)->sizes()[1];
+  lock.unlock();
+  // Number of tokens that have been passed to model with KV cache.
+  size_t pos = 0;
+  int64_t start_pos = 0;
+  tokens.reserve(tokens.size() + options.max_tokens);
+  for (size_t i = 0; i < options.max_tokens; ++i) {
+    er::Error error = er::Error::Ok;
+    // Pass the tokens not in the KV cache in chunks when there are many, or
+    // the latest tokens that fit in the input without KV cache. The lock is
+    // kept after the last execution for reading its logits.
+    do {
+      if (lock)
+        lock.unlock();
+      if (std::string message = CheckCancel(options.cancel.get());
+          !message.empty()) {
+        return message;
+      }
+      lock.lock();
+      if (use_kv_cache) {
+        size_t size = std::min(max_seq_len, tokens.size() - pos);
+        start_pos = pos;
+        error = SetLongInput(*method, 0, tokens.data() + pos, 2, size);
+        if (error == er::Error::Ok)
+          error = SetLongInput(*method, 1, &start_pos, 1, 1);
+        pos += size;
+      } else {
+        size_t size = std::min(max_seq_len, tokens.size());
+        error = SetLongInput(*method, 0, tokens.data() + tokens.size() - size,
+                             2, size);
+      }
+      if (error == er::Error::Ok)
+        error = replica->Run(*method);
+    } while (error == er::Error::Ok && use_kv_cache && pos < tokens.size());
+    if (error != er::Error::Ok)
+      return ErrorCodeToMessage(error);
+    // Sample from the logits of last token, which may be [1, V] or [1, N, V].
+    const ea::Tensor& logits = (*method)->get_output(0).toTensor();
+    if (logits.dim() < 1 || logits.numel() == 0)
+      return "The logits must not be empty.";
+    size_t vocab_size = logits.size(logits.dim() - 1);
+    auto* last = static_cast<const uint8_t*>(logits.const_data_ptr()) +
+                 (logits.numel() - vocab_size) * logits.element_size();
+    int64_t token = SampleLogits(logits.scalar_type(), last, vocab_size,
+                                 options.sampling);
+    lock.unlock();
+    if (std::find(options.stop_tokens.begin(),
+                  options.stop_tokens.end(),
+                  token) != options.stop_tokens.end()) {
+      break;
+    }
+    tokens.push_back(token);
+    on_token(token);
+  }
+  return std::string();
+}
+
+}  // namespace etjs
@@ -0,0 +1,42 @@
+#ifndef SRC_GENERATION_H_
+#define SRC_GENERATION_H_
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "src/sample.h"
+
+namespace etjs {
+
+class CancelState;
+class Replica;
+
+struct GenerationOptions {
+  size_t max_tokens;
+  SamplingOptions sampling;
+  std::vector<int64_t> stop_tokens;
+  // Whether the method takes the start position for its KV cache. When not
+  // set, it is read from the "use_kv_cache" metadata method of the program,
+  // and is false if the program does not have it.
+  std::optional<bool> kv_cache;
+  // Checked before each execution of the method, can be null.
+  std::shared_ptr<CancelState> cancel;
+};
+
+// Run the autoregressive decode loop of the method, which takes tokens of shape
+// [1, N] and also the start position of the tokens when it has KV cache, and
+// returns logits. The |on_token| is called for each generated token, and an
+// error message is returned on failure. The replica is only locked during each
+// execution, so sync executions of other methods can run between the steps.
+std::string Generate(Replica* replica,
+                     const std::string& name,
+                     std::vector<int64_t> tokens,
+                     const GenerationOptions& options,
+                     const std::function<void(int64_t)>& on_token);
+
+}  // namespace etjs
+
+#endif  // SRC_GENERATION_H_
@@ -0,0 +1,77 @@
+#include "src/intra_op.h"
+
+#if defined(ETJS_THREADPOOL)
+#include <executorch/extension/threadpool/threadpool.h>
+#include <executorch/extension/threadpool/threadpool_guard.h>
+#endif
+
+#include <mutex>
+
+namespace etjs {
+
+#if defined(ETJS_THREADPOOL)
+
+namespace et = executorch::extension::threadpool;
+
+namespace {
+
+std::mutex g_mutex;
+// Guarded by g_mutex.
+bool g_frozen = false;
+
+}  // namespace
+
+uint32_t GetIntraOpThreads() {
+  std::lock_guard lock(g_mutex);
+  et::ThreadPool* pool = et::get_threadpool();
+  return pool ? static_cast<uint32_t>(pool->get_thread_count()) : 1;
+}
+
+std::string SetIntraOpThreads(uint32_t num_threads) {
+  if (num_threads == 0)
+    return "The number of threads must be positive.";
+  std::lock_guard lock(g_mutex);
+  if (g_frozen)
+    return "The number of threads must be set before loading any method.";
+  et::ThreadPool* pool = et::get_threadpool();
+  if (!pool || !pool->_unsafe_reset_threadpool(num_threads))
+    return "Failed to create threadpool.";
+  return std::string();
+}
+
+void FreezeIntraOpThreads() {
+  std::lock_guard lock(g_mutex);
+  g_frozen = true;
+}
+
+SingleThreadedScope::SingleThreadedScope(bool enabled) : enabled_(enabled) {
+  if (enabled_) {
+    was_enabled_ = et::NoThreadPoolGuard::is_enabled();
+    et::NoThreadPoolGuard::set_enabled(true);
+  }
+}
+
+SingleThreadedScope::~SingleThreadedScope() {
+  if (enabled_)
+    et::NoThreadPoolGuard::set_enabled(was_enabled_);
+}
+
+#else
+
+uint32_t GetIntraOpThreads() {
+  return 1;
+}
+
+std::string SetIntraOpThreads(uint32_t num_threads) {
+  return "The runtime is built without threadpool.";
+}
+
+void FreezeIntraOpThreads() {}
+
+SingleThreadedScope::SingleThreadedScope(bool enabled) : enabled_(enabled) {}
+
+SingleThreadedScope::~SingleThreadedScope() = default;
+
+#endif
+
+}  // namespace etjs
@@ -0,0 +1,38 @@
+#ifndef SRC_INTRA_OP_H_
+#define SRC_INTRA_OP_H_
+
+#include <cstdint>
+#include <string>
+
+namespace etjs {
+
+// Return the number of threads used by XNNPACK and the optimized kernels to
+// parallelize one operator, or 1 when the runtime is built without threadpool.
+uint32_t GetIntraOpThreads();
+
+// Recreate the threadpool with |num_threads|. Delegates keep the threadpool
+// when methods are loaded, so it can not be changed after any method has been
+// loaded. An error message is returned on failure.
+std::string SetIntraOpThreads(uint32_t num_threads);
+
+// Called before loading a method, after which the threadpool is fixed.
+void FreezeIntraOpThreads();
+
+// Disable the threadpool on current thread in scope, so operators run on the
+// calling thread only.
+class SingleThreadedScope {
+ public:
+  explicit SingleThreadedScope(bool enabled);
+  ~SingleThreadedScope();
+
+  SingleThreadedScope& operator=(const SingleThreadedScope&) = delete;
+  SingleThreadedScope(const SingleThreadedScope&) = delete;
+
+ private:
+  bool enabled_;
+  bool was_enabled_ = false;
+};
+
+}  // namespace etjs
+
+#endif  // SRC_INTRA_OP_H_
@@ -0,0 +1,105 @@
+#include "src/mapped_file.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+namespace etjs {
+
+#if defined(_WIN32)
+
+// static
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string&) {
+  // Not implemented on Windows.
+  return nullptr;
+}
+
+MappedFile::~MappedFile() = default;
+void MappedFile::Advise() {}
+void MappedFile::StartTouchingPages() {}
+size_t MappedFile::GetResidentBytes() const { return 0; }
+
+#else
+
+namespace {
+
+#if defined(__APPLE__)
+using PageStatus = char;
+#else
+using PageStatus = unsigned char;
+#endif
+
+size_t GetPageSize() {
+  static size_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+  struct stat st;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0)
+    data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps the file open.
+  close(fd);
+  if (data == MAP_FAILED)
+    return nullptr;
+  return std::unique_ptr<MappedFile>(new MappedFile(data, st.st_size));
+}
+
+MappedFile::MappedFile(void* data, size_t size) : data_(data), size_(size) {}
+
+MappedFile::~MappedFile() {
+  stop_ = true;
+  if (thread_.joinable())
+    thread_.join();
+  munmap(data_, size_);
+}
+
+void MappedFile::Advise() {
+  madvise(data_, size_, MADV_WILLNEED);
+#if defined(MADV_HUGEPAGE)
+  // Only applies to this mapping, and only when the kernel supports huge pages
+  // for read-only file mappings. The loader maps the file on its own, so it
+  // only benefits from the readahead into the page cache.
+  madvise(data_, size_, MADV_HUGEPAGE);
+#endif
+}
+
+void MappedFile::StartTouchingPages() {
+  if (thread_.joinable())
+    return;
+  thread_ = std::thread([this]() {
+    auto* bytes = static_cast<const volatile uint8_t*>(data_);
+    for (size_t i = 0; i < size_ && !stop_; i += GetPageSize())
+      bytes[i];
+  });
+}
+
+size_t MappedFile::GetResidentBytes() const {
+  size_t page_size = GetPageSize();
+  std::vector<PageStatus> pages((size_ + page_size - 1) / page_size);
+  if (mincore(data_, size_, pages.data()) != 0)
+    return 0;
+  size_t resident = 0;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    if (pages[i] & 1)
+      resident += std::min(page_size, size_ - i * page_size);
+  }
+  return resident;
+}
+
+#endif
+
+}  // namespace etjs
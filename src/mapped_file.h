@@ -0,0 +1,49 @@
+#ifndef SRC_MAPPED_FILE_H_
+#define SRC_MAPPED_FILE_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace etjs {
+
+// Read-only mapping of a model file for advising the kernel and measuring the
+// pages in memory. The pages are in page cache and shared with the mappings
+// made by the data loader.
+class MappedFile {
+ public:
+  // Return null if the file can not be mapped.
+  static std::unique_ptr<MappedFile> Open(const std::string& path);
+
+  ~MappedFile();
+
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(const MappedFile&) = delete;
+
+  // Ask the kernel to read ahead the file into the page cache, which is shared
+  // with the loader's mapping of the file.
+  void Advise();
+
+  // Read one byte of each page in a background thread so the file is paged in
+  // before methods need it.
+  void StartTouchingPages();
+
+  // Return the bytes of the file that are resident in memory.
+  size_t GetResidentBytes() const;
+
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(void* data, size_t size);
+
+  void* data_;
+  const size_t size_;
+
+  std::atomic<bool> stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace etjs
+
+#endif  // SRC_MAPPED_FILE_H_
@@ -1,109 +1,744 @@
 #include "src/module.h"
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
 #include <executorch/extension/data_loader/buffer_data_loader.h>
+#include <executorch/runtime/core/exec_aten/util/tensor_util.h>
 #define FMT_HEADER_ONLY
 #include <fmt/format.h>
 
+#include "src/affinity.h"
+#include "src/batcher.h"
+#include "src/cancel.h"
 #include "src/evalue.h"
 #include "src/error.h"
+#include "src/generation.h"
+#include "src/intra_op.h"
+#include "src/prepared_method.h"
 #include "src/scalar.h"
+#include "src/stats.h"
 #include "src/tensor.h"
+#include "src/warmup.h"
 #include "src/worker.h"
 
 namespace {
 
-// According to MethodMeta::input_tag/output_tag, these are the types we only
-// need to support
-using EValueVariant = std::variant<ea::Tensor, std::string, double, bool>;
-
-std::variant<std::string, er::Result<std::vector<er::EValue>>>
-ExecuteImpl(ee::Module* mod,
-            const std::string& name,
-            const std::vector<EValueVariant>& args) {
-  auto meta = mod->method_meta(name);
-  if (!meta.ok())
-    return fmt::format("Method \"{}\" does not exist.", name);
-  if (meta->num_inputs() != args.size())
+using etjs::EValueVariant;
+
+// Tensors passed by caller for receiving outputs, empty ones are ignored.
+using OutputTensors = std::vector<ea::optional<ea::Tensor>>;
+
+using ExecuteResult =
+    std::variant<std::string, er::Result<std::vector<etjs::OwnedEValue>>>;
+
+// Whether the elements of tensor are stored densely in its dim order.
+bool IsDense(const ea::Tensor& tensor) {
+  std::vector<ea::StridesType> strides(tensor.dim());
+  if (er::dim_order_to_stride(tensor.sizes().data(),
+                              tensor.dim_order().data(),
+                              tensor.dim(),
+                              strides.data()) != er::Error::Ok) {
+    return false;
+  }
+  return std::equal(strides.begin(), strides.end(), tensor.strides().begin());
+}
+
+// Redirect outputs of the method to caller's buffers, and point them back to
+// the method's own buffers when destroyed, so the method never writes into the
+// buffers after the call.
+class OutputRedirects {
+ public:
+  explicit OutputRedirects(er::Method* method) : method_(method) {}
+
+  ~OutputRedirects() {
+    for (const Saved& saved : saved_)
+      method_->set_output_data_ptr(saved.data, saved.nbytes, saved.index);
+  }
+
+  OutputRedirects& operator=(const OutputRedirects&) = delete;
+  OutputRedirects(const OutputRedirects&) = delete;
+
+  // The |max_nbytes| is the upper bound of the output's size.
+  er::Error Redirect(size_t index, void* data, size_t max_nbytes) {
+    void* old = method_->get_output(index).toTensor().mutable_data_ptr();
+    er::Error error = method_->set_output_data_ptr(data, max_nbytes, index);
+    if (error == er::Error::Ok)
+      saved_.push_back({index, old, max_nbytes});
+    return error;
+  }
+
+ private:
+  struct Saved {
+    size_t index;
+    void* data;
+    size_t nbytes;
+  };
+
+  er::Method* method_;
+  std::vector<Saved> saved_;
+};
+
+ExecuteResult ExecuteImpl(etjs::Replica* replica,
+                          const std::string& name,
+                          const std::vector<EValueVariant>& args,
+                          const OutputTensors& outputs,
+                          etjs::CallTimer* timer) {
+  std::lock_guard lock(replica->mutex());
+  auto method = replica->GetMethod(name);
+  if (!method.ok()) {
+    if (method.error() == er::Error::InvalidArgument)
+      return fmt::format("Method \"{}\" does not exist.", name);
+    return method.error();
+  }
+  auto meta = (*method)->method_meta();
+  if (meta.num_inputs() != args.size())
     return fmt::format("Expect {} arg(s) but only got {}.",
-                       meta->num_inputs(), args.size());
-  std::vector<er::EValue> inputs;
+                       meta.num_inputs(), args.size());
+  std::vector<er::EValue> inputs(args.size());
   for (size_t i = 0; i < args.size(); ++i) {
-    er::Tag tag = meta->input_tag(i).get();
-    switch (tag) {
-      case er::Tag::Tensor:
-        if (auto* t = std::get_if<ea::Tensor>(&args[i]); t) {
-          inputs.push_back(er::EValue(std::move(*t)));
-          break;
-        }
-        return fmt::format("Argument {} should be Tensor.", i);
-      case er::Tag::String:
-        if (auto* s = std::get_if<std::string>(&args[i]); s) {
-          inputs.push_back(er::EValue(s->c_str(), s->size()));
-          break;
-        }
-        return fmt::format("Argument {} should be String.", i);
-      case er::Tag::Int:
-        if (auto* d = std::get_if<double>(&args[i]); d) {
-          inputs.push_back(er::EValue(static_cast<int64_t>(*d)));
-          break;
-        }
-        return fmt::format("Argument {} should be interger.", i);
-      case er::Tag::Double:
-        if (auto* d = std::get_if<double>(&args[i]); d) {
-          inputs.push_back(er::EValue(*d));
-          break;
-        }
-        return fmt::format("Argument {} should be number.", i);
-      default:
-        return fmt::format("Unexpected EValue tag {}.", static_cast<int>(tag));
+    std::string error = etjs::ToEValue(meta.input_tag(i).get(), args[i], i,
+                                       &inputs[i]);
+    if (!error.empty())
+      return error;
+  }
+  if (outputs.size() > meta.num_outputs())
+    return fmt::format("Expect at most {} output(s) but got {}.",
+                       meta.num_outputs(), outputs.size());
+  // Outputs that are not memory-planned can be written directly into the
+  // caller's buffers, other ones have to be copied after execution. The size
+  // is checked against the real output after execution, as outputs of dynamic
+  // shapes are only bounded by the sizes in meta.
+  OutputRedirects redirects(*method);
+  std::vector<size_t> copied_outputs;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (!outputs[i])
+      continue;
+    if (meta.output_tag(i).get() != er::Tag::Tensor)
+      return fmt::format("Output {} is not Tensor.", i);
+    const ea::Tensor& out = outputs[i].value();
+    auto info = meta.output_tensor_meta(i);
+    auto dim_order = info->dim_order();
+    if (out.scalar_type() != info->scalar_type() ||
+        static_cast<size_t>(out.dim()) != info->sizes().size() ||
+        !std::equal(dim_order.begin(), dim_order.end(),
+                    out.dim_order().begin()) ||
+        !IsDense(out)) {
+      return fmt::format("Output {} does not match method's output.", i);
+    }
+    if (info->is_memory_planned()) {
+      copied_outputs.push_back(i);
+      continue;
+    }
+    if (out.nbytes() < info->nbytes())
+      return fmt::format("Output {} is smaller than method's output.", i);
+    er::Error error = redirects.Redirect(i, out.mutable_data_ptr(),
+                                         info->nbytes());
+    if (error != er::Error::Ok)
+      return error;
+  }
+  auto result = replica->Execute(*method, inputs, timer);
+  if (!result.ok())
+    return result.error();
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (!outputs[i])
+      continue;
+    const ea::Tensor& src = result->at(i).toTensor();
+    ea::Tensor dst = outputs[i].value();
+    if (src.dim() != dst.dim() ||
+        !std::equal(src.sizes().begin(), src.sizes().end(),
+                    dst.sizes().begin())) {
+      return fmt::format("Output {} has a different shape than expected.", i);
     }
   }
-  return mod->execute(name, inputs);
+  for (size_t i : copied_outputs) {
+    const ea::Tensor& src = result->at(i).toTensor();
+    ea::Tensor dst = outputs[i].value();
+    std::memcpy(dst.mutable_data_ptr(), src.const_data_ptr(), src.nbytes());
+    if (timer)
+      timer->AddCopiedBytes(src.nbytes());
+  }
+  // The outputs written to caller's tensors are returned as None, so they are
+  // not copied again.
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (outputs[i])
+      result->at(i) = er::EValue();
+  }
+  // Other outputs are copied while the replica is locked, as the next
+  // execution overwrites them before the result is converted to JS.
+  std::vector<etjs::OwnedEValue> owned = etjs::CopyOutputs(*result);
+  if (timer) {
+    timer->Mark(etjs::ExecutionStats::kOutputs);
+    for (const er::EValue& output : *result) {
+      if (output.isTensor()) {
+        timer->AddCopiedBytes(output.toTensor().nbytes());
+        timer->AddAllocation();
+      }
+    }
+  }
+  return std::move(owned);
 }
 
-napi_value Execute(ee::Module* mod,
+// Run ExecuteImpl and mark the call as failed on error.
+ExecuteResult ExecuteAndRecord(etjs::Replica* replica,
+                               const std::string& name,
+                               const std::vector<EValueVariant>& args,
+                               const OutputTensors& outputs,
+                               etjs::CallTimer* timer) {
+  ExecuteResult result = ExecuteImpl(replica, name, args, outputs, timer);
+  if (timer && (std::holds_alternative<std::string>(result) ||
+                !std::get<1>(result).ok())) {
+    timer->SetFailed();
+  }
+  return result;
+}
+
+napi_value Execute(etjs::Module* mod,
                    napi_env env,
                    std::string name,
-                   std::vector<EValueVariant> args) {
-  return etjs::RunInWorker<decltype(ExecuteImpl(mod, name, args))>(
+                   std::vector<EValueVariant> args,
+                   OutputTensors outputs,
+                   std::shared_ptr<etjs::CancelState> cancel) {
+  std::shared_ptr<etjs::Replica> replica = mod->PickReplica();
+  if (!replica) {
+    ki::ThrowError(env, "Module is not loaded.");
+    return nullptr;
+  }
+  std::shared_ptr<etjs::CallTimer> timer;
+  if (mod->stats())
+    timer = std::make_shared<etjs::CallTimer>(mod->stats());
+  return etjs::RunInQueue<ExecuteResult>(
       env,
-      "execute",
-      [mod, name = std::move(name), args = std::move(args)]() {
-        return ExecuteImpl(mod, name, args);
-      });
+      replica->queue(),
+      [replica,
+       timer,
+       name = std::move(name),
+       args = std::move(args),
+       outputs = std::move(outputs),
+       cancel = std::move(cancel)]() -> ExecuteResult {
+        // Drop the execution that is cancelled while waiting in queue.
+        if (std::string error = etjs::CheckCancel(cancel.get());
+            !error.empty()) {
+          if (timer)
+            timer->SetFailed();
+          return error;
+        }
+        return ExecuteAndRecord(replica.get(), name, args, outputs,
+                                timer.get());
+      },
+      timer);
 }
 
-napi_value ExecuteSync(ee::Module* mod,
+napi_value ExecuteSync(etjs::Module* mod,
                        napi_env env,
                        const std::string& name,
-                       const std::vector<EValueVariant>& args) {
-  return ki::ToNodeValue(env, ExecuteImpl(mod, name, args));
+                       const std::vector<EValueVariant>& args,
+                       const OutputTensors& outputs) {
+  std::shared_ptr<etjs::Replica> replica = mod->PickReplica();
+  if (!replica) {
+    ki::ThrowError(env, "Module is not loaded.");
+    return nullptr;
+  }
+  std::unique_ptr<etjs::CallTimer> timer;
+  if (mod->stats())
+    timer = std::make_unique<etjs::CallTimer>(mod->stats());
+  napi_value result = ki::ToNodeValue(
+      env, ExecuteAndRecord(replica.get(), name, args, outputs, timer.get()));
+  if (timer) {
+    timer->Mark(etjs::ExecutionStats::kConvert);
+    timer->Finish();
+  }
+  return result;
+}
+
+std::string EnableBatching(etjs::Module* mod,
+                           const std::string& name,
+                           uint32_t max_batch_size,
+                           double max_wait_ms) {
+  if (mod->GetBatcher(name))
+    return fmt::format("Batching is already enabled for \"{}\".", name);
+  if (max_batch_size < 2)
+    return "The max batch size must be larger than 1.";
+  // The meta does not tell whether a shape is dynamic, so the method is loaded
+  // to read it from the input tensors.
+  std::shared_ptr<etjs::Replica> replica = mod->PickReplica();
+  if (!replica)
+    return "Module is not loaded.";
+  std::lock_guard lock(replica->mutex());
+  auto method = replica->GetMethod(name);
+  if (!method.ok()) {
+    if (method.error() == er::Error::InvalidArgument)
+      return fmt::format("Method \"{}\" does not exist.", name);
+    return etjs::ErrorCodeToMessage(method.error());
+  }
+  auto meta = (*method)->method_meta();
+  // Inputs must be tensors whose first dimension is a dynamic batch dimension,
+  // and the max batch size is limited by the upper bound of the shape.
+  std::vector<etjs::Batcher::InputSpec> specs;
+  for (size_t i = 0; i < meta.num_inputs(); ++i) {
+    if (meta.input_tag(i).get() != er::Tag::Tensor)
+      return fmt::format("Argument {} is not Tensor.", i);
+    auto info = meta.input_tensor_meta(i);
+    auto sizes = info->sizes();
+    if (sizes.size() == 0 || sizes[0] < 2 ||
+        (*method)->get_input(i).toTensor().shape_dynamism() ==
+            er::TensorShapeDynamism::STATIC) {
+      return fmt::format("Argument {} does not have batch dimension.", i);
+    }
+    max_batch_size = std::min<uint32_t>(max_batch_size, sizes[0]);
+    specs.push_back({info->scalar_type(),
+                     std::vector<ea::SizesType>(sizes.begin(), sizes.end())});
+  }
+  for (size_t i = 0; i < meta.num_outputs(); ++i) {
+    if (meta.output_tag(i).get() != er::Tag::Tensor)
+      return fmt::format("Output {} is not Tensor.", i);
+  }
+  mod->SetBatcher(name, std::make_unique<etjs::Batcher>(
+      mod,
+      name,
+      std::move(specs),
+      max_batch_size,
+      std::chrono::microseconds(static_cast<int64_t>(max_wait_ms * 1000))));
+  return std::string();
+}
+
+napi_value ExecuteBatched(etjs::Module* mod,
+                          napi_env env,
+                          const std::string& name,
+                          std::vector<ea::Tensor> inputs,
+                          std::shared_ptr<etjs::CancelState> cancel) {
+  etjs::Batcher* batcher = mod->GetBatcher(name);
+  if (!batcher) {
+    ki::ThrowError(env, "Batching is not enabled for the method.");
+    return nullptr;
+  }
+  return batcher->Execute(env, std::move(inputs), std::move(cancel));
+}
+
+napi_value GetBatchingStats(etjs::Module* mod,
+                            napi_env env,
+                            const std::string& name,
+                            bool reset) {
+  etjs::Batcher* batcher = mod->GetBatcher(name);
+  if (!batcher)
+    return nullptr;
+  napi_value result = ki::ToNodeValue(env, batcher->GetStats());
+  if (reset)
+    batcher->ResetStats();
+  return result;
+}
+
+// Sent from the generation loop to JS thread, for each generated token and
+// once more when the loop finishes.
+struct GenerateEvent {
+  int64_t token = 0;
+  bool done = false;
+  std::string error;
+};
+
+void CallGenerateCallback(napi_env env,
+                          napi_value callback,
+                          void* context,
+                          void* data) {
+  std::unique_ptr<GenerateEvent> event(static_cast<GenerateEvent*>(data));
+  if (!env)
+    return;
+  napi_value args[2];
+  if (event->done) {
+    napi_get_null(env, &args[0]);
+    if (event->error.empty())
+      napi_get_undefined(env, &args[1]);
+    else
+      args[1] = ki::ToNodeValue(env, event->error);
+  } else {
+    args[0] = ki::ToNodeValue(env, static_cast<double>(event->token));
+    napi_get_undefined(env, &args[1]);
+  }
+  napi_value undefined;
+  napi_get_undefined(env, &undefined);
+  napi_call_function(env, undefined, callback, 2, args, nullptr);
+}
+
+// Send |event| to JS, and free it when the threadsafe function is closing.
+void SendGenerateEvent(napi_threadsafe_function tsfn,
+                       GenerateEvent* event,
+                       napi_threadsafe_function_call_mode mode) {
+  if (napi_call_threadsafe_function(tsfn, event, mode) != napi_ok)
+    delete event;
 }
 
-napi_value Load(ee::Module* mod,
+bool Generate(etjs::Module* mod,
+              napi_env env,
+              std::string name,
+              const std::vector<double>& prompt,
+              uint32_t max_tokens,
+              const etjs::SamplingOptions& sampling,
+              const std::vector<double>& stop_tokens,
+              std::optional<bool> kv_cache,
+              std::shared_ptr<etjs::CancelState> cancel,
+              napi_value callback) {
+  std::shared_ptr<etjs::Replica> replica = mod->PickReplica();
+  if (!replica) {
+    ki::ThrowError(env, "Module is not loaded.");
+    return false;
+  }
+  // Tokens are sent to JS with a threadsafe function, which is released when
+  // the generation finishes.
+  napi_threadsafe_function tsfn;
+  if (napi_create_threadsafe_function(
+          env, callback, nullptr, ki::ToNodeValue(env, "generate"), 0, 1,
+          nullptr, nullptr, nullptr, &CallGenerateCallback,
+          &tsfn) != napi_ok) {
+    ki::ThrowError(env, "Failed to create threadsafe function.");
+    return false;
+  }
+  etjs::GenerationOptions options;
+  options.max_tokens = max_tokens;
+  options.sampling = sampling;
+  options.stop_tokens.assign(stop_tokens.begin(), stop_tokens.end());
+  options.kv_cache = kv_cache;
+  options.cancel = std::move(cancel);
+  std::vector<int64_t> tokens(prompt.begin(), prompt.end());
+  auto ran = std::make_shared<bool>(false);
+  bool posted = replica->queue()->Post(
+      env,
+      [replica,
+       tsfn,
+       ran,
+       name = std::move(name),
+       tokens = std::move(tokens),
+       options = std::move(options)]() {
+        *ran = true;
+        std::string error = etjs::Generate(
+            replica.get(), name, tokens, options,
+            [tsfn](int64_t token) {
+              SendGenerateEvent(tsfn, new GenerateEvent{token},
+                                napi_tsfn_blocking);
+            });
+        SendGenerateEvent(tsfn, new GenerateEvent{0, true, std::move(error)},
+                          napi_tsfn_blocking);
+        napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+      },
+      [tsfn, ran](napi_env) {
+        // Finish the generation when the queue is destroyed before running it.
+        if (*ran)
+          return;
+        SendGenerateEvent(
+            tsfn, new GenerateEvent{0, true, "Module has been closed."},
+            napi_tsfn_nonblocking);
+        napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+      });
+  if (!posted) {
+    napi_release_threadsafe_function(tsfn, napi_tsfn_abort);
+    ki::ThrowError(env, "Failed to queue work.");
+    return false;
+  }
+  return true;
+}
+
+napi_value LoadMethodAsync(etjs::Module* mod,
+                           napi_env env,
+                           std::string name) {
+  return etjs::RunInQueue<er::Error>(
+      env,
+      mod->queue(),
+      [mod = mod->shared_from_this(), name = std::move(name)]() {
+        return mod->LoadMethod(name);
+      });
+}
+
+napi_value Warmup(etjs::Module* mod,
+                  napi_env env,
+                  std::string name,
+                  uint32_t iterations) {
+  using R = std::variant<std::string, etjs::WarmupResult>;
+  std::vector<std::shared_ptr<etjs::Replica>> replicas = mod->GetReplicas();
+  if (replicas.empty()) {
+    ki::ThrowError(env, "Module is not loaded.");
+    return nullptr;
+  }
+  return etjs::RunInQueue<R>(
+      env,
+      mod->queue(),
+      [replicas = std::move(replicas),
+       name = std::move(name),
+       iterations]() {
+        return etjs::Warmup(replicas, name, std::max<uint32_t>(iterations, 1));
+      });
+}
+
+napi_value Load(etjs::Module* mod,
                 napi_env env,
                 er::Program::Verification verification) {
-  return etjs::RunInWorker<decltype(mod->load())>(
+  return etjs::RunInQueue<er::Error>(
       env,
-      "load",
-      [mod, verification]() {
-        return mod->load(verification);
+      mod->queue(),
+      [mod = mod->shared_from_this(), verification]() {
+        return mod->Load(verification);
       });
 }
 
 }  // namespace
 
-namespace ki {
+namespace etjs {
 
-template<>
-struct Type<er::EventTracer*> {
-  static constexpr const char* name = "EventTracer";
-  static std::optional<er::EventTracer*> FromNode(napi_env env,
-                                                  napi_value value) {
-    // Always pass nullptr for now.
-    return static_cast<er::EventTracer*>(nullptr);
+Module::Module(napi_env env,
+               std::string file_path,
+               std::unique_ptr<er::DataLoader> loader,
+               size_t num_replicas,
+               bool profiling,
+               LoadOptions load_options,
+               bool share_program,
+               bool single_threaded)
+    : env_(env),
+      file_path_(std::move(file_path)),
+      num_replicas_(std::max<size_t>(num_replicas, 1)),
+      profiling_(profiling),
+      load_options_(load_options),
+      share_program_(share_program),
+      single_threaded_(single_threaded),
+      loader_(std::move(loader)) {
+  napi_add_env_cleanup_hook(env_, &Module::OnEnvCleanup, this);
+}
+
+Module::~Module() {
+  napi_remove_env_cleanup_hook(env_, &Module::OnEnvCleanup, this);
+}
+
+// static
+Module* Module::Retain(std::shared_ptr<Module> mod) {
+  mod->self_ = mod;
+  return mod.get();
+}
+
+// static
+void Module::Release(Module* mod) {
+  // May destroy the module, so the reference is moved out first.
+  std::shared_ptr<Module> self = std::move(mod->self_);
+}
+
+er::Error Module::Load(er::Program::Verification verification) {
+  std::lock_guard lock(mutex_);
+  if (closed_)
+    return er::Error::InvalidState;
+  if (program_)
+    return er::Error::Ok;
+  if (loader_) {
+    auto program = er::Program::load(loader_.get(), verification);
+    if (!program.ok())
+      return program.error();
+    program_ = std::make_shared<LoadedProgram>();
+    program_->loader = std::move(loader_);
+    program_->program = std::make_unique<er::Program>(
+        std::move(program.get()));
+  } else {
+    auto program =
+        share_program_
+            ? ProgramRegistry::GetDefault()->Load(file_path_, load_options_,
+                                                  verification)
+            : LoadProgram(file_path_, load_options_, verification);
+    if (!program.ok())
+      return program.error();
+    program_ = std::move(program.get());
   }
-};
+  // The replicas share the program, and load methods on demand.
+  for (size_t i = 0; i < num_replicas_; ++i)
+    replicas_.push_back(
+        std::make_shared<Replica>(program_, i, profiling_, single_threaded_));
+  if (!cpus_.empty())
+    ApplyAffinity();
+  return er::Error::Ok;
+}
+
+std::string Module::SetAffinity(std::vector<uint32_t> cpus, bool pin) {
+  if (!IsThreadAffinitySupported())
+    return "Thread affinity is not supported on this platform.";
+  for (uint32_t cpu : cpus) {
+    if (!IsCpuAllowed(cpu))
+      return fmt::format("CPU {} is not available to the process.", cpu);
+  }
+  std::lock_guard lock(mutex_);
+  cpus_ = std::move(cpus);
+  pin_threads_ = pin;
+  queue_.SetAffinity(cpus_);
+  ApplyAffinity();
+  return std::string();
+}
+
+std::string Module::GetAffinityError() {
+  std::lock_guard lock(mutex_);
+  bool failed = queue_.affinity_failed();
+  for (const std::shared_ptr<Replica>& replica : replicas_)
+    failed = failed || replica->queue()->affinity_failed();
+  if (failed)
+    return "Failed to bind threads to the CPUs.";
+  return std::string();
+}
+
+std::optional<MemoryUsage> Module::GetMemoryUsage() {
+  std::lock_guard lock(mutex_);
+  if (!program_ || !program_->mapped_file)
+    return std::nullopt;
+  const MappedFile& file = *program_->mapped_file;
+  return MemoryUsage{file.size(), file.GetResidentBytes()};
+}
+
+size_t Module::GetProgramRefCount() {
+  std::lock_guard lock(mutex_);
+  if (!program_)
+    return 0;
+  return program_.use_count() - program_->num_replicas;
+}
+
+void Module::EnableStats() {
+  if (!stats_)
+    stats_ = std::make_shared<ExecutionStats>();
+}
+
+std::optional<ExecutionStats::Snapshot> Module::GetStats(bool reset) {
+  if (!stats_)
+    return std::nullopt;
+  ExecutionStats::Snapshot snapshot = stats_->GetSnapshot();
+  if (reset)
+    stats_->Reset();
+  return snapshot;
+}
+
+uint32_t Module::GetIntraOpThreads() {
+  return single_threaded_ ? 1 : etjs::GetIntraOpThreads();
+}
+
+bool Module::IsLoaded() {
+  std::lock_guard lock(mutex_);
+  return !!program_;
+}
+
+er::Result<std::vector<std::string>> Module::MethodNames() {
+  std::lock_guard lock(mutex_);
+  if (!program_)
+    return er::Error::InvalidState;
+  std::vector<std::string> names;
+  for (size_t i = 0; i < program_->program->num_methods(); ++i) {
+    auto name = program_->program->get_method_name(i);
+    if (!name.ok())
+      return name.error();
+    names.push_back(name.get());
+  }
+  return names;
+}
+
+er::Error Module::LoadMethod(const std::string& name) {
+  // Do not hold the module's lock when loading, which may take long and block
+  // the JS thread when it picks replicas.
+  std::vector<std::shared_ptr<Replica>> replicas = GetReplicas();
+  if (replicas.empty())
+    return er::Error::InvalidState;
+  for (const auto& replica : replicas) {
+    std::lock_guard replica_lock(replica->mutex());
+    er::Error error = replica->LoadMethod(name);
+    if (error != er::Error::Ok)
+      return error;
+  }
+  return er::Error::Ok;
+}
+
+bool Module::IsMethodLoaded(const std::string& name) {
+  std::lock_guard lock(mutex_);
+  if (replicas_.empty())
+    return false;
+  return replicas_[0]->IsMethodLoaded(name);
+}
+
+er::Result<er::MethodMeta> Module::GetMethodMeta(const std::string& name) {
+  std::lock_guard lock(mutex_);
+  if (!program_)
+    return er::Error::InvalidState;
+  return program_->program->method_meta(name.c_str());
+}
+
+std::vector<Profiler::Run> Module::GetProfile(bool reset) {
+  std::lock_guard lock(mutex_);
+  std::vector<Profiler::Run> runs;
+  for (auto& replica : replicas_) {
+    if (!replica->profiler())
+      continue;
+    auto replica_runs = replica->profiler()->GetRuns(reset);
+    runs.insert(runs.end(),
+                std::make_move_iterator(replica_runs.begin()),
+                std::make_move_iterator(replica_runs.end()));
+  }
+  return runs;
+}
+
+void Module::SetBatcher(const std::string& name,
+                        std::unique_ptr<Batcher> batcher) {
+  batchers_[name] = std::move(batcher);
+}
+
+Batcher* Module::GetBatcher(const std::string& name) {
+  auto it = batchers_.find(name);
+  return it != batchers_.end() ? it->second.get() : nullptr;
+}
+
+std::vector<std::shared_ptr<Replica>> Module::GetReplicas() {
+  std::lock_guard lock(mutex_);
+  return replicas_;
+}
+
+std::shared_ptr<Replica> Module::PickReplica() {
+  std::lock_guard lock(mutex_);
+  if (replicas_.empty())
+    return nullptr;
+  // Start searching from the one after last picked, so replicas are used in
+  // turn when they are equally loaded.
+  std::shared_ptr<Replica> picked;
+  for (size_t i = 0; i < replicas_.size(); ++i) {
+    size_t index = (next_replica_ + i) % replicas_.size();
+    const std::shared_ptr<Replica>& replica = replicas_[index];
+    if (!picked || replica->queue()->pending() < picked->queue()->pending()) {
+      picked = replica;
+      if (replica->queue()->pending() == 0) {
+        next_replica_ = index + 1;
+        break;
+      }
+    }
+  }
+  return picked;
+}
+
+void Module::ApplyAffinity() {
+  for (size_t i = 0; i < replicas_.size(); ++i) {
+    if (pin_threads_ && !cpus_.empty())
+      replicas_[i]->queue()->SetAffinity({cpus_[i % cpus_.size()]});
+    else
+      replicas_[i]->queue()->SetAffinity(cpus_);
+  }
+}
+
+// static
+void Module::OnEnvCleanup(void* data) {
+  auto* mod = static_cast<Module*>(data);
+  // Wait for running tasks before releasing what they use, the module's lock
+  // is not held as the tasks may take it.
+  mod->queue_.Shutdown();
+  std::vector<std::shared_ptr<Replica>> replicas;
+  {
+    std::lock_guard lock(mod->mutex_);
+    mod->closed_ = true;
+    replicas.swap(mod->replicas_);
+  }
+  for (const auto& replica : replicas)
+    replica->queue()->Shutdown();
+  mod->batchers_.clear();
+  replicas.clear();
+  std::lock_guard lock(mod->mutex_);
+  mod->program_.reset();
+}
+
+}  // namespace etjs
+
+namespace ki {
 
 template<>
 struct Type<er::Program::Verification> {
@@ -121,18 +756,56 @@ struct Type<er::Program::Verification> {
   }
 };
 
-template<typename T>
-struct Type<er::Result<T>> {
-  static constexpr const char* name = Type<T>::name;
-  static napi_status ToNode(napi_env env,
-                            const er::Result<T>& value,
-                            napi_value* result) {
-    if (!value.ok())
-      return ConvertToNode(env, value.error(), result);
-    return ConvertToNode(env, value.get(), result);
+template<>
+struct Type<etjs::LoadOptions::Mode> {
+  static constexpr const char* name = "LoadMode";
+  static std::optional<etjs::LoadOptions::Mode> FromNode(napi_env env,
+                                                         napi_value value) {
+    auto str = FromNodeTo<std::string>(env, value);
+    if (!str)
+      return std::nullopt;
+    if (*str == "mmap")
+      return etjs::LoadOptions::Mode::Mmap;
+    if (*str == "mmap-mlock")
+      return etjs::LoadOptions::Mode::MmapUseMlock;
+    if (*str == "mmap-mlock-ignore-errors")
+      return etjs::LoadOptions::Mode::MmapUseMlockIgnoreErrors;
+    if (*str == "file")
+      return etjs::LoadOptions::Mode::File;
+    return std::nullopt;
   }
 };
 
+template<>
+struct Type<etjs::LoadOptions::Prefetch> {
+  static constexpr const char* name = "Prefetch";
+  static std::optional<etjs::LoadOptions::Prefetch> FromNode(
+      napi_env env,
+      napi_value value) {
+    auto str = FromNodeTo<std::string>(env, value);
+    if (!str)
+      return std::nullopt;
+    if (*str == "none")
+      return etjs::LoadOptions::Prefetch::None;
+    if (*str == "advise")
+      return etjs::LoadOptions::Prefetch::Advise;
+    if (*str == "touch")
+      return etjs::LoadOptions::Prefetch::Touch;
+    return std::nullopt;
+  }
+};
+
+// static
+napi_status Type<etjs::MemoryUsage>::ToNode(napi_env env,
+                                            const etjs::MemoryUsage& value,
+                                            napi_value* result) {
+  *result = CreateObject(env);
+  Set(env, *result,
+      "fileBytes", static_cast<double>(value.file_bytes),
+      "residentBytes", static_cast<double>(value.resident_bytes));
+  return napi_ok;
+}
+
 template<>
 struct Type<er::TensorInfo> {
   static constexpr const char* name = "TensorInfo";
@@ -168,37 +841,71 @@ struct Type<er::MethodMeta> : public AllowPassByValue<er::MethodMeta> {
 };
 
 // static
-void Type<ee::Module>::Define(napi_env env, napi_value, napi_value prototype) {
+void Type<etjs::Module>::Define(napi_env env,
+                                napi_value,
+                                napi_value prototype) {
   Set(env, prototype,
       "load", MemberFunction(&Load),
-      "loadSync", &ee::Module::load,
-      "isLoaded", &ee::Module::is_loaded,
-      "methodNames", &ee::Module::method_names,
-      "loadMethod", &ee::Module::load_method,
-      "isMethodLoaded", &ee::Module::is_method_loaded,
-      "methodMeta", &ee::Module::method_meta,
+      "loadSync", &etjs::Module::Load,
+      "isLoaded", &etjs::Module::IsLoaded,
+      "methodNames", &etjs::Module::MethodNames,
+      "loadMethod", &etjs::Module::LoadMethod,
+      "loadMethodAsync", MemberFunction(&LoadMethodAsync),
+      "isMethodLoaded", &etjs::Module::IsMethodLoaded,
+      "methodMeta", &etjs::Module::GetMethodMeta,
+      "getProfile", &etjs::Module::GetProfile,
+      "getMemoryUsage", &etjs::Module::GetMemoryUsage,
+      "getProgramRefCount", &etjs::Module::GetProgramRefCount,
+      "setAffinity", &etjs::Module::SetAffinity,
+      "getAffinityError", &etjs::Module::GetAffinityError,
+      "getIntraOpThreads", &etjs::Module::GetIntraOpThreads,
+      "enableStats", &etjs::Module::EnableStats,
+      "getStats", &etjs::Module::GetStats,
       "execute", MemberFunction(&Execute),
-      "executeSync", MemberFunction(&ExecuteSync));
+      "executeSync", MemberFunction(&ExecuteSync),
+      "enableBatching", MemberFunction(&EnableBatching),
+      "executeBatched", MemberFunction(&ExecuteBatched),
+      "getBatchingStats", MemberFunction(&GetBatchingStats),
+      "warmup", MemberFunction(&Warmup),
+      "prepare", MemberFunction(&etjs::PreparedMethod::Create),
+      "generate", MemberFunction(&Generate));
 }
 
 // static
-ee::Module* Type<ee::Module>::Constructor(Arguments* args) {
+etjs::Module* Type<etjs::Module>::Constructor(Arguments* args) {
+  std::string file_path;
+  std::unique_ptr<er::DataLoader> loader;
   if (auto s = args->TryGetNext<std::string>(); s) {
-    return new ee::Module(s.value(),
-                          // Some linux envs do not support mlock.
-                          ee::Module::LoadMode::MmapUseMlockIgnoreErrors);
-  }
-  if (auto u = args->GetNext<etjs::Buffer>(); u) {
-    return new ee::Module(std::make_unique<ee::BufferDataLoader>(u->data,
-                                                                 u->size));
+    file_path = std::move(s.value());
+  } else if (auto u = args->TryGetNext<etjs::Buffer>(); u) {
+    loader = std::make_unique<ee::BufferDataLoader>(u->data, u->size);
+  } else {
+    args->ThrowError("String or Buffer");
+    return nullptr;
   }
-  args->ThrowError("String or Buffer");
-  return nullptr;
+  uint32_t num_replicas = args->TryGetNext<uint32_t>().value_or(1);
+  bool profiling = args->TryGetNext<bool>().value_or(false);
+  etjs::LoadOptions load_options;
+  if (auto mode = args->TryGetNext<etjs::LoadOptions::Mode>(); mode)
+    load_options.mode = *mode;
+  if (auto prefetch = args->TryGetNext<etjs::LoadOptions::Prefetch>(); prefetch)
+    load_options.prefetch = *prefetch;
+  bool share_program = args->TryGetNext<bool>().value_or(true);
+  bool single_threaded = args->TryGetNext<bool>().value_or(false);
+  return etjs::Module::Retain(std::make_shared<etjs::Module>(
+      args->Env(),
+      std::move(file_path),
+      std::move(loader),
+      num_replicas,
+      profiling,
+      load_options,
+      share_program,
+      single_threaded));
 }
 
 // static
-void Type<ee::Module>::Destructor(ee::Module* mod) {
-  delete mod;
+void Type<etjs::Module>::Destructor(etjs::Module* mod) {
+  etjs::Module::Release(mod);
 }
 
 }  // namespace ki
@@ -1,19 +1,162 @@
 #ifndef SRC_MODULE_H_
 #define SRC_MODULE_H_
 
-#include <executorch/extension/module/module.h>
+#include <executorch/runtime/executor/program.h>
 #include <kizunapi.h>
 
-namespace ee = executorch::extension;
+#include "src/program_registry.h"
+#include "src/replica.h"
+#include "src/stats.h"
+
+namespace er = executorch::runtime;
+
+namespace etjs {
+
+class Batcher;
+
+struct MemoryUsage {
+  size_t file_bytes;
+  // Bytes of the model file resident in memory.
+  size_t resident_bytes;
+};
+
+// Load a program and create replicas of its methods, async operations on the
+// module run on the queues of replicas instead of the libuv pool. The module is
+// referenced by JS and by the tasks running on its queue.
+class Module : public std::enable_shared_from_this<Module> {
+ public:
+  // When |loader| is null, the |file_path| is loaded with |load_options|, and
+  // the program is shared with other modules of the same file when
+  // |share_program| is true. When |single_threaded| is true, the methods do
+  // not use the intra-op threadpool.
+  Module(napi_env env,
+         std::string file_path,
+         std::unique_ptr<er::DataLoader> loader,
+         size_t num_replicas,
+         bool profiling,
+         LoadOptions load_options,
+         bool share_program,
+         bool single_threaded);
+  ~Module();
+
+  Module& operator=(const Module&) = delete;
+  Module(const Module&) = delete;
+
+  // Keep |mod| alive for JS until Release is called, and return the pointer
+  // wrapped by JS.
+  static Module* Retain(std::shared_ptr<Module> mod);
+  // Drop the reference held by JS.
+  static void Release(Module* mod);
+
+  er::Error Load(er::Program::Verification verification);
+  bool IsLoaded();
+  er::Result<std::vector<std::string>> MethodNames();
+  er::Error LoadMethod(const std::string& name);
+  bool IsMethodLoaded(const std::string& name);
+  er::Result<er::MethodMeta> GetMethodMeta(const std::string& name);
+
+  // Return the memory used by the model file, or nullopt if the module is not
+  // loaded from file.
+  std::optional<MemoryUsage> GetMemoryUsage();
+
+  // Return the number of modules using the loaded program, or 0 if not loaded.
+  size_t GetProgramRefCount();
+
+  // Run the threads of module on |cpus|, and when |pin| is true, bind the
+  // thread of each replica to one of the |cpus| in turn. An error message is
+  // returned on failure.
+  std::string SetAffinity(std::vector<uint32_t> cpus, bool pin);
+
+  // Return an error message if any thread of module failed to apply the last
+  // affinity, which happens before the next task of each thread.
+  std::string GetAffinityError();
+
+  // Return the finished runs profiled in all replicas.
+  std::vector<Profiler::Run> GetProfile(bool reset);
+
+  // Return all replicas, which are empty if not loaded. Tasks hold the replicas
+  // they run in, so they can finish after the module is gone.
+  std::vector<std::shared_ptr<Replica>> GetReplicas();
+
+  // Return the replica with least pending tasks, or null if not loaded. Must be
+  // called on JS thread.
+  std::shared_ptr<Replica> PickReplica();
+
+  // Batchers of methods, must be accessed on JS thread.
+  void SetBatcher(const std::string& name, std::unique_ptr<Batcher> batcher);
+  Batcher* GetBatcher(const std::string& name);
+
+  // Record the latency breakdown of executions from now on, must be called on
+  // JS thread.
+  void EnableStats();
+  // Return the recorded stats and optionally reset them, or nullopt if not
+  // enabled.
+  std::optional<ExecutionStats::Snapshot> GetStats(bool reset);
+
+  // Return the number of threads used to run one operator.
+  uint32_t GetIntraOpThreads();
+
+  const std::shared_ptr<ExecutionStats>& stats() const { return stats_; }
+  size_t num_replicas() const { return num_replicas_; }
+  WorkQueue* queue() { return &queue_; }
+
+ private:
+  // Stop the queues and release the replicas and program when env is torn
+  // down, as the module may not be garbage collected before a worker thread
+  // exits. The module can not be loaded again after that.
+  static void OnEnvCleanup(void* data);
+
+  // Apply the affinity to the queues of replicas, must be called with lock.
+  void ApplyAffinity();
+
+  // The reference held by JS.
+  std::shared_ptr<Module> self_;
+
+  napi_env env_;
+  std::string file_path_;
+  const size_t num_replicas_;
+  const bool profiling_;
+  const LoadOptions load_options_;
+  const bool share_program_;
+  const bool single_threaded_;
+
+  // Guard the program and replicas, which are created on load.
+  std::mutex mutex_;
+  std::unique_ptr<er::DataLoader> loader_;
+  std::shared_ptr<LoadedProgram> program_;
+  // The batchers run tasks in replicas, so must outlive them.
+  std::unordered_map<std::string, std::unique_ptr<Batcher>> batchers_;
+  std::vector<std::shared_ptr<Replica>> replicas_;
+  size_t next_replica_ = 0;
+  std::vector<uint32_t> cpus_;
+  bool pin_threads_ = false;
+  // Set when env is torn down.
+  bool closed_ = false;
+  // Shared with the calls being timed.
+  std::shared_ptr<ExecutionStats> stats_;
+
+  // Used for loading, must be destroyed before the program.
+  WorkQueue queue_;
+};
+
+}  // namespace etjs
 
 namespace ki {
 
 template<>
-struct Type<ee::Module> {
+struct Type<etjs::Module> {
   static constexpr const char* name = "Module";
   static void Define(napi_env env, napi_value, napi_value prototype);
-  static ee::Module* Constructor(Arguments* args);
-  static void Destructor(ee::Module* mod);
+  static etjs::Module* Constructor(Arguments* args);
+  static void Destructor(etjs::Module* mod);
+};
+
+template<>
+struct Type<etjs::MemoryUsage> {
+  static constexpr const char* name = "MemoryUsage";
+  static napi_status ToNode(napi_env env,
+                            const etjs::MemoryUsage& value,
+                            napi_value* result);
 };
 
 }  // namespace ki
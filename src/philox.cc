@@ -0,0 +1,60 @@
+#include "src/philox.h"
+
+#include <array>
+#include <random>
+
+namespace etjs {
+
+namespace {
+
+// Constants from the Random123 library.
+constexpr uint32_t kPhiloxM0 = 0xD2511F53;
+constexpr uint32_t kPhiloxM1 = 0xCD9E8D57;
+constexpr uint32_t kPhiloxW0 = 0x9E3779B9;
+constexpr uint32_t kPhiloxW1 = 0xBB67AE85;
+
+std::array<uint32_t, 4> Philox4x32(std::array<uint32_t, 4> ctr,
+                                   std::array<uint32_t, 2> key) {
+  for (int round = 0; round < 10; ++round) {
+    uint64_t p0 = static_cast<uint64_t>(kPhiloxM0) * ctr[0];
+    uint64_t p1 = static_cast<uint64_t>(kPhiloxM1) * ctr[2];
+    ctr = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+           static_cast<uint32_t>(p1),
+           static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+           static_cast<uint32_t>(p0)};
+    key[0] += kPhiloxW0;
+    key[1] += kPhiloxW1;
+  }
+  return ctr;
+}
+
+}  // namespace
+
+Philox::Philox(uint64_t seed, uint64_t offset)
+    : seed_(seed), offset_(offset) {}
+
+Philox::~Philox() = default;
+
+// static
+Philox* Philox::GetDefault() {
+  static Philox* philox = []() {
+    std::random_device device;
+    uint64_t seed = (static_cast<uint64_t>(device()) << 32) | device();
+    return new Philox(seed);
+  }();
+  return philox;
+}
+
+float Philox::NextFloat() {
+  uint64_t counter = offset_.fetch_add(1, std::memory_order_relaxed);
+  auto result = Philox4x32({static_cast<uint32_t>(counter),
+                            static_cast<uint32_t>(counter >> 32),
+                            0,
+                            0},
+                           {static_cast<uint32_t>(seed_),
+                            static_cast<uint32_t>(seed_ >> 32)});
+  // Use the high 24 bits so the float is exact and less than 1.
+  return (result[0] >> 8) * (1.0f / (1 << 24));
+}
+
+}  // namespace etjs
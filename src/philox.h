@@ -0,0 +1,37 @@
+#ifndef SRC_PHILOX_H_
+#define SRC_PHILOX_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace etjs {
+
+// Counter-based random number generator with the Philox4x32-10 algorithm, the
+// n-th number only depends on the seed and n, so the numbers can be drawn from
+// multiple threads without locks.
+class Philox {
+ public:
+  explicit Philox(uint64_t seed, uint64_t offset = 0);
+  ~Philox();
+
+  Philox& operator=(const Philox&) = delete;
+  Philox(const Philox&) = delete;
+
+  // The generator used when none is specified, which is seeded randomly.
+  static Philox* GetDefault();
+
+  // Return a float in [0, 1) and advance the offset.
+  float NextFloat();
+
+  uint64_t seed() const { return seed_; }
+  uint64_t offset() const { return offset_; }
+  void set_offset(uint64_t offset) { offset_ = offset; }
+
+ private:
+  const uint64_t seed_;
+  std::atomic<uint64_t> offset_;
+};
+
+}  // namespace etjs
+
+#endif  // SRC_PHILOX_H_
@@ -0,0 +1,159 @@
+#include "src/prepared_method.h"
+
+#define FMT_HEADER_ONLY
+#include <fmt/format.h>
+
+#include "src/error.h"
+#include "src/module.h"
+#include "src/tensor.h"
+#include "src/worker.h"
+
+namespace {
+
+napi_value Execute(etjs::PreparedMethod* method,
+                   napi_env env,
+                   std::vector<etjs::EValueVariant> args) {
+  return etjs::RunInQueue<etjs::PreparedMethod::Result>(
+      env,
+      method->replica()->queue(),
+      [method = method->shared_from_this(), args = std::move(args)]() {
+        return method->Execute(args);
+      });
+}
+
+// Unbind the input when |value| is undefined, and reject disposed tensors
+// instead of treating them as undefined.
+std::string SetInput(etjs::PreparedMethod* method,
+                     napi_env env,
+                     uint32_t index,
+                     napi_value value) {
+  napi_valuetype type;
+  if (napi_typeof(env, value, &type) == napi_ok && type == napi_undefined)
+    return method->SetInput(index, ea::optional<ea::Tensor>());
+  etjs::Tensor* tensor;
+  if (!ki::Get(env, value, "holder", &tensor))
+    return fmt::format("Input {} is not Tensor.", index);
+  if (tensor->disposed())
+    return fmt::format("Input {} has been disposed.", index);
+  return method->SetInput(index, ea::Tensor(tensor->impl()));
+}
+
+}  // namespace
+
+namespace etjs {
+
+// static
+std::variant<std::string, PreparedMethod*> PreparedMethod::Create(
+    Module* mod,
+    const std::string& name) {
+  std::shared_ptr<Replica> replica = mod->PickReplica();
+  if (!replica)
+    return std::string("Module is not loaded.");
+  std::lock_guard lock(replica->mutex());
+  auto method = replica->GetMethod(name);
+  if (!method.ok()) {
+    if (method.error() == er::Error::InvalidArgument)
+      return fmt::format("Method \"{}\" does not exist.", name);
+    return std::string(ErrorCodeToMessage(method.error()));
+  }
+  std::shared_ptr<PreparedMethod> prepared(
+      new PreparedMethod(replica, *method, name));
+  prepared->self_ = prepared;
+  return prepared.get();
+}
+
+// static
+void PreparedMethod::Release(PreparedMethod* method) {
+  // May destroy the method, so the reference is moved out first.
+  std::shared_ptr<PreparedMethod> self = std::move(method->self_);
+}
+
+PreparedMethod::PreparedMethod(std::shared_ptr<Replica> replica,
+                               er::Method* method,
+                               std::string name)
+    : replica_(std::move(replica)),
+      method_(method),
+      name_(std::move(name)),
+      outputs_(method->outputs_size()) {
+  er::MethodMeta meta = method_->method_meta();
+  for (size_t i = 0; i < meta.num_inputs(); ++i)
+    input_tags_.push_back(meta.input_tag(i).get());
+  bound_inputs_.resize(input_tags_.size());
+}
+
+PreparedMethod::~PreparedMethod() = default;
+
+PreparedMethod::Result PreparedMethod::Execute(
+    const std::vector<EValueVariant>& args) {
+  bool use_bound_inputs = args.empty();
+  if (!use_bound_inputs && args.size() != input_tags_.size())
+    return fmt::format("Expect {} arg(s) but only got {}.",
+                       input_tags_.size(), args.size());
+  std::lock_guard lock(replica_->mutex());
+  for (size_t i = 0; i < input_tags_.size(); ++i) {
+    er::EValue input;
+    if (use_bound_inputs) {
+      // The data of bound tensors may have changed, so they are set again.
+      if (!bound_inputs_[i])
+        return fmt::format("Input {} is not set.", i);
+      const ea::Tensor& tensor = bound_inputs_[i].value();
+      if (tensor.nbytes() > 0 && !tensor.const_data_ptr())
+        return fmt::format("Input {} has been disposed.", i);
+      input = er::EValue(tensor);
+    } else {
+      std::string message = ToEValue(input_tags_[i], args[i], i, &input);
+      if (!message.empty())
+        return message;
+    }
+    er::Error error = method_->set_input(input, i);
+    if (error != er::Error::Ok)
+      return error;
+  }
+  er::Error error = replica_->Run(method_);
+  if (error != er::Error::Ok)
+    return error;
+  error = method_->get_outputs(outputs_.data(), outputs_.size());
+  if (error != er::Error::Ok)
+    return error;
+  // The outputs point to the method's memory, which the next execution in
+  // the replica's queue overwrites before they are converted to JS.
+  return CopyOutputs(outputs_);
+}
+
+std::string PreparedMethod::SetInput(uint32_t index,
+                                     ea::optional<ea::Tensor> tensor) {
+  if (index >= input_tags_.size())
+    return fmt::format("Input {} is out of range.", index);
+  if (tensor && input_tags_[index] != er::Tag::Tensor)
+    return fmt::format("Input {} is not Tensor.", index);
+  std::lock_guard lock(replica_->mutex());
+  if (tensor) {
+    // Check the tensor against the method's input now rather than on the
+    // first execution.
+    er::Error error = method_->set_input(er::EValue(*tensor), index);
+    if (error != er::Error::Ok)
+      return ErrorCodeToMessage(error);
+  }
+  bound_inputs_[index] = std::move(tensor);
+  return std::string();
+}
+
+}  // namespace etjs
+
+namespace ki {
+
+// static
+void Type<etjs::PreparedMethod>::Define(napi_env env,
+                                        napi_value,
+                                        napi_value prototype) {
+  DefineProperties(env, prototype,
+                   Property("name", Getter(&etjs::PreparedMethod::name)),
+                   Property("numInputs",
+                            Getter(&etjs::PreparedMethod::num_inputs)));
+  Set(env, prototype,
+      "execute", MemberFunction(&Execute),
+      "executeSync", &etjs::PreparedMethod::Execute,
+      "setInput", MemberFunction(&SetInput));
+}
+
+}  // namespace ki
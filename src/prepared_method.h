@@ -0,0 +1,98 @@
+#ifndef SRC_PREPARED_METHOD_H_
+#define SRC_PREPARED_METHOD_H_
+
+#include <executorch/runtime/executor/method.h>
+#include <kizunapi.h>
+
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "src/evalue.h"
+
+namespace etjs {
+
+class Module;
+class Replica;
+
+// A method loaded in one replica, whose signature is read once when prepared
+// so executions only check arguments against the cached tags and set them as
+// inputs directly. Queued executions hold the prepared method, which holds the
+// replica, so neither is freed before the executions finish.
+class PreparedMethod : public std::enable_shared_from_this<PreparedMethod> {
+ public:
+  using Result =
+      std::variant<std::string, er::Result<std::vector<OwnedEValue>>>;
+
+  // Load the method in the replica picked from |mod|, an error message is
+  // returned on failure. The returned object is referenced by JS until
+  // Release is called. Must be called on JS thread.
+  static std::variant<std::string, PreparedMethod*> Create(
+      Module* mod,
+      const std::string& name);
+
+  // Drop the reference held by JS.
+  static void Release(PreparedMethod* method);
+
+  ~PreparedMethod();
+
+  PreparedMethod& operator=(const PreparedMethod&) = delete;
+  PreparedMethod(const PreparedMethod&) = delete;
+
+  // Set inputs and execute the method under the replica's lock, and copy the
+  // outputs before releasing it. When no argument is passed, the bound inputs
+  // are used instead.
+  Result Execute(const std::vector<EValueVariant>& args);
+
+  // Bind |tensor| as the |index|-th input, which is read on every execution
+  // without arguments so its data can be updated in place between calls. Pass
+  // nullopt to unbind. An error message is returned on failure.
+  std::string SetInput(uint32_t index, ea::optional<ea::Tensor> tensor);
+
+  const std::string& name() const { return name_; }
+  size_t num_inputs() const { return input_tags_.size(); }
+  Replica* replica() const { return replica_.get(); }
+
+ private:
+  PreparedMethod(std::shared_ptr<Replica> replica,
+                 er::Method* method,
+                 std::string name);
+
+  // The reference held by JS.
+  std::shared_ptr<PreparedMethod> self_;
+  // Owns the |method_|.
+  std::shared_ptr<Replica> replica_;
+  er::Method* method_;
+  const std::string name_;
+  std::vector<er::Tag> input_tags_;
+  // The bound inputs, only accessed under the replica's lock.
+  std::vector<ea::optional<ea::Tensor>> bound_inputs_;
+  // Reused for reading outputs, only accessed under the replica's lock.
+  std::vector<er::EValue> outputs_;
+};
+
+}  // namespace etjs
+
+namespace ki {
+
+template<>
+struct Type<etjs::PreparedMethod> {
+  static constexpr const char* name = "PreparedMethod";
+  static void Define(napi_env env, napi_value, napi_value prototype);
+};
+
+// Prepared methods are created in C++ and owned by JS.
+template<>
+struct TypeBridge<etjs::PreparedMethod> {
+  static inline etjs::PreparedMethod* Wrap(etjs::PreparedMethod* ptr) {
+    return ptr;
+  }
+  static inline void Finalize(etjs::PreparedMethod* ptr) {
+    etjs::PreparedMethod::Release(ptr);
+  }
+};
+
+}  // namespace ki
+
+#endif  // SRC_PREPARED_METHOD_H_
@@ -0,0 +1,187 @@
+#include "src/profiler.h"
+
+#include <executorch/runtime/platform/platform.h>
+
+namespace etjs {
+
+Profiler::Profiler(size_t replica, size_t max_runs)
+    : replica_(replica), max_runs_(max_runs) {}
+
+Profiler::~Profiler() = default;
+
+void Profiler::BeginRun(const char* method) {
+  current_ = {method, replica_, 0, {}};
+  running_ = true;
+  run_start_ = et_pal_current_ticks();
+}
+
+void Profiler::EndRun() {
+  if (!running_)
+    return;
+  current_.duration = ToRunTime(et_pal_current_ticks());
+  running_ = false;
+  std::lock_guard lock(mutex_);
+  if (runs_.size() >= max_runs_)
+    runs_.pop_front();
+  runs_.push_back(std::move(current_));
+}
+
+std::vector<Profiler::Run> Profiler::GetRuns(bool reset) {
+  std::lock_guard lock(mutex_);
+  std::vector<Run> runs(runs_.begin(), runs_.end());
+  if (reset)
+    runs_.clear();
+  return runs;
+}
+
+void Profiler::create_event_block(const char* name) {}
+
+er::EventTracerEntry Profiler::start_profiling(const char* name,
+                                               er::ChainID chain_id,
+                                               er::DebugHandle debug_handle) {
+  return StartEvent(name, false, chain_id, debug_handle);
+}
+
+void Profiler::end_profiling(er::EventTracerEntry entry) {
+  EndEvent(entry);
+}
+
+er::EventTracerEntry Profiler::start_profiling_delegate(
+    const char* name,
+    er::DebugHandle delegate_debug_index) {
+  return StartEvent(name ? name : "", true, er::kUnsetChainId,
+                    delegate_debug_index);
+}
+
+void Profiler::end_profiling_delegate(er::EventTracerEntry entry,
+                                      const void* metadata,
+                                      size_t metadata_len) {
+  EndEvent(entry);
+}
+
+void Profiler::log_profiling_delegate(const char* name,
+                                      er::DebugHandle delegate_debug_index,
+                                      et_timestamp_t start_time,
+                                      et_timestamp_t end_time,
+                                      const void* metadata,
+                                      size_t metadata_len) {
+  if (!running_)
+    return;
+  current_.events.push_back({name ? name : "",
+                             true,
+                             er::kUnsetChainId,
+                             delegate_debug_index,
+                             ToRunTime(start_time),
+                             ToRunTime(end_time)});
+}
+
+void Profiler::track_allocation(er::AllocatorID id, size_t size) {}
+
+er::AllocatorID Profiler::track_allocator(const char* name) {
+  return next_allocator_id_++;
+}
+
+void Profiler::log_evalue(const er::EValue& evalue,
+                          er::LoggedEValueType evalue_type) {}
+
+void Profiler::log_intermediate_output_delegate(
+    const char* name,
+    er::DebugHandle delegate_debug_index,
+    const ea::Tensor& output) {}
+
+void Profiler::log_intermediate_output_delegate(
+    const char* name,
+    er::DebugHandle delegate_debug_index,
+    const er::ArrayRef<ea::Tensor> output) {}
+
+void Profiler::log_intermediate_output_delegate(
+    const char* name,
+    er::DebugHandle delegate_debug_index,
+    const int& output) {}
+
+void Profiler::log_intermediate_output_delegate(
+    const char* name,
+    er::DebugHandle delegate_debug_index,
+    const bool& output) {}
+
+void Profiler::log_intermediate_output_delegate(
+    const char* name,
+    er::DebugHandle delegate_debug_index,
+    const double& output) {}
+
+uint64_t Profiler::ToRunTime(et_timestamp_t ticks) const {
+  if (ticks < run_start_)
+    return 0;
+  et_tick_ratio_t ratio = et_pal_ticks_to_ns_multiplier();
+  return (ticks - run_start_) * ratio.numerator / ratio.denominator;
+}
+
+er::EventTracerEntry Profiler::StartEvent(const char* name,
+                                          bool delegate,
+                                          er::ChainID chain_id,
+                                          er::DebugHandle debug_handle) {
+  er::EventTracerEntry entry = {};
+  entry.event_id = -1;
+  entry.chain_id = chain_id;
+  entry.debug_handle = debug_handle;
+  entry.start_time = et_pal_current_ticks();
+  if (running_) {
+    // The event is recorded on start so nested events keep their order.
+    std::vector<Event>& events = current_.events;
+    entry.event_id = static_cast<int64_t>(events.size());
+    events.push_back({name,
+                      delegate,
+                      chain_id,
+                      debug_handle,
+                      ToRunTime(entry.start_time),
+                      0});
+  }
+  return entry;
+}
+
+void Profiler::EndEvent(const er::EventTracerEntry& entry) {
+  if (!running_ || entry.event_id < 0)
+    return;
+  std::vector<Event>& events = current_.events;
+  if (static_cast<size_t>(entry.event_id) < events.size())
+    events[entry.event_id].end = ToRunTime(et_pal_current_ticks());
+}
+
+}  // namespace etjs
+
+namespace ki {
+
+// static
+napi_status Type<etjs::Profiler::Event>::ToNode(
+    napi_env env,
+    const etjs::Profiler::Event& value,
+    napi_value* result) {
+  *result = CreateObject(env);
+  Set(env, *result,
+      "name", value.name,
+      "type", value.delegate ? "delegate" : "operator",
+      "start", value.start / 1e6,
+      "duration", value.end > value.start ? (value.end - value.start) / 1e6
+                                          : 0.0);
+  if (value.chain_id != er::kUnsetChainId)
+    Set(env, *result, "chainId", static_cast<double>(value.chain_id));
+  if (value.debug_handle != er::kUnsetDebugHandle)
+    Set(env, *result, "debugHandle", static_cast<double>(value.debug_handle));
+  return napi_ok;
+}
+
+// static
+napi_status Type<etjs::Profiler::Run>::ToNode(
+    napi_env env,
+    const etjs::Profiler::Run& value,
+    napi_value* result) {
+  *result = CreateObject(env);
+  Set(env, *result,
+      "method", value.method,
+      "replica", static_cast<double>(value.replica),
+      "duration", value.duration / 1e6,
+      "events", value.events);
+  return napi_ok;
+}
+
+}  // namespace ki
@@ -0,0 +1,142 @@
+#ifndef SRC_PROFILER_H_
+#define SRC_PROFILER_H_
+
+#include <executorch/runtime/core/event_tracer.h>
+#include <kizunapi.h>
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ea = executorch::aten;
+namespace er = executorch::runtime;
+
+namespace etjs {
+
+// Record the operator and delegate events of executions, a profiler is attached
+// to all methods of a replica so the events are only recorded under replica's
+// lock. Finished runs have their own lock so they can be read at any time.
+class Profiler : public er::EventTracer {
+ public:
+  struct Event {
+    std::string name;
+    bool delegate;
+    er::ChainID chain_id;
+    er::DebugHandle debug_handle;
+    // Time in nanoseconds since the start of the run.
+    uint64_t start;
+    uint64_t end;
+  };
+
+  struct Run {
+    std::string method;
+    size_t replica;
+    uint64_t duration;
+    std::vector<Event> events;
+  };
+
+  // Only the latest |max_runs| runs are kept.
+  explicit Profiler(size_t replica, size_t max_runs = 1000);
+  ~Profiler() override;
+
+  Profiler& operator=(const Profiler&) = delete;
+  Profiler(const Profiler&) = delete;
+
+  // Mark the start and end of an execution of the method.
+  void BeginRun(const char* method);
+  void EndRun();
+
+  // Return finished runs and optionally clear them, the run in progress is not
+  // included. Can be called from any thread.
+  std::vector<Run> GetRuns(bool reset);
+
+  // er::EventTracer:
+  void create_event_block(const char* name) override;
+  er::EventTracerEntry start_profiling(
+      const char* name,
+      er::ChainID chain_id,
+      er::DebugHandle debug_handle) override;
+  void end_profiling(er::EventTracerEntry entry) override;
+  er::EventTracerEntry start_profiling_delegate(
+      const char* name,
+      er::DebugHandle delegate_debug_index) override;
+  void end_profiling_delegate(er::EventTracerEntry entry,
+                              const void* metadata,
+                              size_t metadata_len) override;
+  void log_profiling_delegate(const char* name,
+                              er::DebugHandle delegate_debug_index,
+                              et_timestamp_t start_time,
+                              et_timestamp_t end_time,
+                              const void* metadata,
+                              size_t metadata_len) override;
+  void track_allocation(er::AllocatorID id, size_t size) override;
+  er::AllocatorID track_allocator(const char* name) override;
+  void log_evalue(const er::EValue& evalue,
+                  er::LoggedEValueType evalue_type) override;
+  void log_intermediate_output_delegate(
+      const char* name,
+      er::DebugHandle delegate_debug_index,
+      const ea::Tensor& output) override;
+  void log_intermediate_output_delegate(
+      const char* name,
+      er::DebugHandle delegate_debug_index,
+      const er::ArrayRef<ea::Tensor> output) override;
+  void log_intermediate_output_delegate(
+      const char* name,
+      er::DebugHandle delegate_debug_index,
+      const int& output) override;
+  void log_intermediate_output_delegate(
+      const char* name,
+      er::DebugHandle delegate_debug_index,
+      const bool& output) override;
+  void log_intermediate_output_delegate(
+      const char* name,
+      er::DebugHandle delegate_debug_index,
+      const double& output) override;
+
+ private:
+  // Convert ticks of the platform to nanoseconds since the start of the run.
+  uint64_t ToRunTime(et_timestamp_t ticks) const;
+  er::EventTracerEntry StartEvent(const char* name,
+                                  bool delegate,
+                                  er::ChainID chain_id,
+                                  er::DebugHandle debug_handle);
+  void EndEvent(const er::EventTracerEntry& entry);
+
+  const size_t replica_;
+  const size_t max_runs_;
+  // The run in progress.
+  Run current_;
+  // Events outside of BeginRun/EndRun are ignored.
+  bool running_ = false;
+  et_timestamp_t run_start_ = 0;
+  er::AllocatorID next_allocator_id_ = 0;
+
+  std::mutex mutex_;
+  std::deque<Run> runs_;
+};
+
+}  // namespace etjs
+
+namespace ki {
+
+template<>
+struct Type<etjs::Profiler::Event> {
+  static constexpr const char* name = "ProfileEvent";
+  static napi_status ToNode(napi_env env,
+                            const etjs::Profiler::Event& value,
+                            napi_value* result);
+};
+
+template<>
+struct Type<etjs::Profiler::Run> {
+  static constexpr const char* name = "ProfileRun";
+  static napi_status ToNode(napi_env env,
+                            const etjs::Profiler::Run& value,
+                            napi_value* result);
+};
+
+}  // namespace ki
+
+#endif  // SRC_PROFILER_H_
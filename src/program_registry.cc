@@ -0,0 +1,131 @@
+#include "src/program_registry.h"
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/extension/data_loader/mmap_data_loader.h>
+
+#include <filesystem>
+
+namespace ee = executorch::extension;
+
+namespace etjs {
+
+namespace {
+
+er::Error CreateLoader(const std::string& path,
+                       LoadOptions::Mode mode,
+                       std::unique_ptr<er::DataLoader>* result) {
+  if (mode == LoadOptions::Mode::File) {
+    auto loader = ee::FileDataLoader::from(path.c_str());
+    if (!loader.ok())
+      return loader.error();
+    *result = std::make_unique<ee::FileDataLoader>(std::move(loader.get()));
+    return er::Error::Ok;
+  }
+  auto mlock_config = ee::MmapDataLoader::MlockConfig::NoMlock;
+  if (mode == LoadOptions::Mode::MmapUseMlock)
+    mlock_config = ee::MmapDataLoader::MlockConfig::UseMlock;
+  else if (mode == LoadOptions::Mode::MmapUseMlockIgnoreErrors)
+    mlock_config = ee::MmapDataLoader::MlockConfig::UseMlockIgnoreErrors;
+  auto loader = ee::MmapDataLoader::from(path.c_str(), mlock_config);
+  if (!loader.ok())
+    return loader.error();
+  *result = std::make_unique<ee::MmapDataLoader>(std::move(loader.get()));
+  return er::Error::Ok;
+}
+
+// Identify the program by the real path of file, so different spellings of
+// one path share the program.
+std::string GetKey(const std::string& path,
+                   const LoadOptions& options,
+                   er::Program::Verification verification) {
+  std::error_code ec;
+  std::filesystem::path real = std::filesystem::weakly_canonical(path, ec);
+  return (ec ? path : real.string()) + '\0' +
+         std::to_string(static_cast<int>(options.mode)) + '\0' +
+         std::to_string(static_cast<int>(verification));
+}
+
+}  // namespace
+
+er::Result<std::shared_ptr<LoadedProgram>> LoadProgram(
+    const std::string& path,
+    const LoadOptions& options,
+    er::Program::Verification verification) {
+  auto result = std::make_shared<LoadedProgram>();
+  // Start reading the file before the program parses it. The file loader reads
+  // the segments into its own memory, so there is nothing to map for it.
+  if (options.mode != LoadOptions::Mode::File)
+    result->mapped_file = MappedFile::Open(path);
+  if (result->mapped_file && options.prefetch != LoadOptions::Prefetch::None)
+    result->mapped_file->Advise();
+  if (result->mapped_file && options.prefetch == LoadOptions::Prefetch::Touch)
+    result->mapped_file->StartTouchingPages();
+  er::Error error = CreateLoader(path, options.mode, &result->loader);
+  if (error != er::Error::Ok)
+    return error;
+  auto program = er::Program::load(result->loader.get(), verification);
+  if (!program.ok())
+    return program.error();
+  result->program = std::make_unique<er::Program>(std::move(program.get()));
+  return result;
+}
+
+ProgramRegistry::ProgramRegistry() = default;
+
+ProgramRegistry::~ProgramRegistry() = default;
+
+// static
+ProgramRegistry* ProgramRegistry::GetDefault() {
+  // Leaked so programs released by worker threads on exit never outlive it.
+  static ProgramRegistry* registry = new ProgramRegistry;
+  return registry;
+}
+
+er::Result<std::shared_ptr<LoadedProgram>> ProgramRegistry::Load(
+    const std::string& path,
+    const LoadOptions& options,
+    er::Program::Verification verification) {
+  std::shared_ptr<Entry> entry;
+  {
+    std::lock_guard lock(mutex_);
+    // Remove the entries of freed programs.
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->second->loads == 0 && it->second->program.expired())
+        it = entries_.erase(it);
+      else
+        ++it;
+    }
+    std::shared_ptr<Entry>& slot =
+        entries_[GetKey(path, options, verification)];
+    if (!slot)
+      slot = std::make_shared<Entry>();
+    if (auto program = slot->program.lock(); program)
+      return program;
+    entry = slot;
+    entry->loads++;
+  }
+  // Only lock the entry when loading so other files can load in parallel, and
+  // concurrent loads of this file wait for the first one.
+  std::lock_guard load_lock(entry->load_mutex);
+  std::shared_ptr<LoadedProgram> program;
+  {
+    std::lock_guard lock(mutex_);
+    program = entry->program.lock();
+  }
+  er::Error error = er::Error::Ok;
+  if (!program) {
+    auto result = LoadProgram(path, options, verification);
+    if (result.ok())
+      program = std::move(result.get());
+    else
+      error = result.error();
+  }
+  std::lock_guard lock(mutex_);
+  entry->loads--;
+  if (!program)
+    return error;
+  entry->program = program;
+  return program;
+}
+
+}  // namespace etjs
@@ -0,0 +1,91 @@
+#ifndef SRC_PROGRAM_REGISTRY_H_
+#define SRC_PROGRAM_REGISTRY_H_
+
+#include <executorch/runtime/executor/program.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "src/mapped_file.h"
+
+namespace er = executorch::runtime;
+
+namespace etjs {
+
+// How the model file is loaded, ignored when the module is created from buffer.
+struct LoadOptions {
+  enum class Mode {
+    Mmap,
+    MmapUseMlock,
+    MmapUseMlockIgnoreErrors,
+    // Read the segments of file into memory.
+    File,
+  };
+  // Ignored in File mode.
+  enum class Prefetch {
+    None,
+    // Advise the kernel to read ahead the file.
+    Advise,
+    // Also read all pages of the file in a background thread.
+    Touch,
+  };
+  Mode mode = Mode::MmapUseMlockIgnoreErrors;
+  Prefetch prefetch = Prefetch::None;
+};
+
+// A program with the data it is loaded from, which is immutable after loading
+// and can be used by methods on any thread.
+struct LoadedProgram {
+  std::unique_ptr<MappedFile> mapped_file;
+  // Must outlive the program.
+  std::unique_ptr<er::DataLoader> loader;
+  std::unique_ptr<er::Program> program;
+  // Replicas keep the program alive too, but are not counted as its users.
+  std::atomic<size_t> num_replicas = 0;
+};
+
+// Load the program of the file at |path|.
+er::Result<std::shared_ptr<LoadedProgram>> LoadProgram(
+    const std::string& path,
+    const LoadOptions& options,
+    er::Program::Verification verification);
+
+// Process-wide programs loaded from files, so modules of the same file created
+// in different worker threads share the weights and delegate state. A program
+// is freed when the last module using it is gone.
+class ProgramRegistry {
+ public:
+  ProgramRegistry();
+  ~ProgramRegistry();
+
+  ProgramRegistry& operator=(const ProgramRegistry&) = delete;
+  ProgramRegistry(const ProgramRegistry&) = delete;
+
+  // The registry shared by all envs.
+  static ProgramRegistry* GetDefault();
+
+  // Return the program of |path| loaded with the same mode and verification,
+  // or load it. Concurrent loads of the same program wait for the first one.
+  er::Result<std::shared_ptr<LoadedProgram>> Load(
+      const std::string& path,
+      const LoadOptions& options,
+      er::Program::Verification verification);
+
+ private:
+  struct Entry {
+    std::mutex load_mutex;
+    // Guarded by the registry's lock.
+    std::weak_ptr<LoadedProgram> program;
+    size_t loads = 0;
+  };
+
+  std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<Entry>> entries_;
+};
+
+}  // namespace etjs
+
+#endif  // SRC_PROGRAM_REGISTRY_H_
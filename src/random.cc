@@ -0,0 +1,52 @@
+#include "src/random.h"
+
+#include <random>
+
+namespace etjs {
+
+Generator::Generator(std::shared_ptr<Philox> philox)
+    : philox_(std::move(philox)) {}
+
+Generator::~Generator() = default;
+
+Generator* Generator::Clone() const {
+  return new Generator(std::make_shared<Philox>(philox_->seed(),
+                                                philox_->offset()));
+}
+
+}  // namespace etjs
+
+namespace ki {
+
+// static
+void Type<etjs::Generator>::Define(napi_env env,
+                                   napi_value constructor,
+                                   napi_value prototype) {
+  Set(env, prototype,
+      "seed", &etjs::Generator::seed,
+      "offset", &etjs::Generator::offset,
+      "setOffset", &etjs::Generator::SetOffset,
+      "clone", &etjs::Generator::Clone);
+}
+
+// static
+etjs::Generator* Type<etjs::Generator>::Constructor(
+    std::optional<double> seed) {
+  uint64_t value;
+  if (seed) {
+    value = static_cast<uint64_t>(*seed);
+  } else {
+    // Keep the seed in the range of safe integers of JS.
+    std::random_device device;
+    value = ((static_cast<uint64_t>(device()) << 32) | device()) &
+            ((uint64_t{1} << 53) - 1);
+  }
+  return new etjs::Generator(std::make_shared<etjs::Philox>(value));
+}
+
+// static
+void Type<etjs::Generator>::Destructor(etjs::Generator* ptr) {
+  // Memory is managed by TypeBridge<etjs::Generator>::Finalize.
+}
+
+}  // namespace ki
@@ -0,0 +1,61 @@
+#ifndef SRC_RANDOM_H_
+#define SRC_RANDOM_H_
+
+#include <memory>
+#include <optional>
+
+#include <kizunapi.h>
+
+#include "src/philox.h"
+
+namespace etjs {
+
+// The random generator exposed to JS, its state can be shared with tasks that
+// may outlive the JS object.
+class Generator {
+ public:
+  explicit Generator(std::shared_ptr<Philox> philox);
+  ~Generator();
+
+  Generator& operator=(const Generator&) = delete;
+  Generator(const Generator&) = delete;
+
+  // Create a generator with the same seed and offset.
+  Generator* Clone() const;
+
+  double seed() const { return philox_->seed(); }
+  double offset() const { return philox_->offset(); }
+  void SetOffset(double offset) { philox_->set_offset(offset); }
+
+  const std::shared_ptr<Philox>& philox() const { return philox_; }
+
+ private:
+  std::shared_ptr<Philox> philox_;
+};
+
+}  // namespace etjs
+
+namespace ki {
+
+template<>
+struct Type<etjs::Generator> {
+  static constexpr const char* name = "Generator";
+  static void Define(napi_env env, napi_value, napi_value prototype);
+  static etjs::Generator* Constructor(std::optional<double> seed);
+  static void Destructor(etjs::Generator* ptr);
+};
+
+// Allow returning new generators to JS.
+template<>
+struct TypeBridge<etjs::Generator> {
+  static inline etjs::Generator* Wrap(etjs::Generator* ptr) {
+    return ptr;
+  }
+  static inline void Finalize(etjs::Generator* ptr) {
+    delete ptr;
+  }
+};
+
+}  // namespace ki
+
+#endif  // SRC_RANDOM_H_
@@ -0,0 +1,109 @@
+#include "src/replica.h"
+
+#include <executorch/runtime/core/hierarchical_allocator.h>
+#include <executorch/runtime/executor/memory_manager.h>
+#include <executorch/runtime/executor/method.h>
+
+#include "src/intra_op.h"
+#include "src/stats.h"
+
+namespace etjs {
+
+Replica::Replica(std::shared_ptr<LoadedProgram> program,
+                 size_t index,
+                 bool profiling,
+                 bool single_threaded)
+    : program_(std::move(program)),
+      single_threaded_(single_threaded),
+      profiler_(profiling ? std::make_unique<Profiler>(index) : nullptr) {
+  program_->num_replicas++;
+}
+
+Replica::~Replica() {
+  program_->num_replicas--;
+}
+
+er::Error Replica::LoadMethod(const std::string& name) {
+  if (methods_.count(name) > 0)
+    return er::Error::Ok;
+  auto meta = program_->program->method_meta(name.c_str());
+  if (!meta.ok())
+    return meta.error();
+  // Allocate the planned memory of this replica.
+  MethodHolder holder;
+  size_t num_buffers = meta->num_memory_planned_buffers();
+  holder.planned_buffers.reserve(num_buffers);
+  holder.planned_spans.reserve(num_buffers);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    size_t size = meta->memory_planned_buffer_size(i).get();
+    holder.planned_buffers.emplace_back(size);
+    holder.planned_spans.emplace_back(holder.planned_buffers.back().data(),
+                                      size);
+  }
+  holder.planned_memory = std::make_unique<er::HierarchicalAllocator>(
+      er::Span<er::Span<uint8_t>>(holder.planned_spans.data(),
+                                  holder.planned_spans.size()));
+  holder.memory_manager = std::make_unique<er::MemoryManager>(
+      &method_allocator_, holder.planned_memory.get(), &temp_allocator_);
+  // Delegates take the threadpool when initialized.
+  FreezeIntraOpThreads();
+  SingleThreadedScope scope(single_threaded_);
+  auto method = program_->program->load_method(name.c_str(),
+                                               holder.memory_manager.get(),
+                                               profiler_.get());
+  if (!method.ok())
+    return method.error();
+  holder.method = std::make_unique<er::Method>(std::move(method.get()));
+  methods_.emplace(name, std::move(holder));
+  std::lock_guard lock(names_mutex_);
+  method_names_.insert(name);
+  return er::Error::Ok;
+}
+
+bool Replica::IsMethodLoaded(const std::string& name) const {
+  std::lock_guard lock(names_mutex_);
+  return method_names_.count(name) > 0;
+}
+
+er::Result<er::Method*> Replica::GetMethod(const std::string& name) {
+  er::Error error = LoadMethod(name);
+  if (error != er::Error::Ok)
+    return error;
+  return methods_.at(name).method.get();
+}
+
+er::Error Replica::Run(er::Method* method) {
+  if (profiler_)
+    profiler_->BeginRun(method->method_meta().name());
+  SingleThreadedScope scope(single_threaded_);
+  er::Error error = method->execute();
+  if (profiler_)
+    profiler_->EndRun();
+  temp_allocator_.reset();
+  return error;
+}
+
+er::Result<std::vector<er::EValue>> Replica::Execute(
+    er::Method* method,
+    const std::vector<er::EValue>& inputs,
+    CallTimer* timer) {
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    er::Error error = method->set_input(inputs[i], i);
+    if (error != er::Error::Ok)
+      return error;
+  }
+  if (timer)
+    timer->Mark(ExecutionStats::kInputs);
+  er::Error error = Run(method);
+  if (error != er::Error::Ok)
+    return error;
+  if (timer)
+    timer->Mark(ExecutionStats::kExecute);
+  std::vector<er::EValue> outputs(method->outputs_size());
+  error = method->get_outputs(outputs.data(), outputs.size());
+  if (error != er::Error::Ok)
+    return error;
+  return outputs;
+}
+
+}  // namespace etjs
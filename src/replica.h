@@ -0,0 +1,90 @@
+#ifndef SRC_REPLICA_H_
+#define SRC_REPLICA_H_
+
+#include <executorch/extension/memory_allocator/malloc_memory_allocator.h>
+#include <executorch/runtime/executor/program.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "src/profiler.h"
+#include "src/program_registry.h"
+#include "src/work_queue.h"
+
+namespace ee = executorch::extension;
+namespace er = executorch::runtime;
+
+namespace etjs {
+
+class CallTimer;
+
+// Methods instantiated from a shared program, each replica has its own planned
+// memory and queue so replicas of one program can run in parallel. The replica
+// keeps the program alive, so tasks holding it can outlive the module.
+class Replica {
+ public:
+  // When |profiling| is true, the executions of methods are profiled. When
+  // |single_threaded| is true, methods are loaded and executed without the
+  // intra-op threadpool.
+  Replica(std::shared_ptr<LoadedProgram> program,
+          size_t index,
+          bool profiling,
+          bool single_threaded);
+  ~Replica();
+
+  Replica& operator=(const Replica&) = delete;
+  Replica(const Replica&) = delete;
+
+  er::Error LoadMethod(const std::string& name);
+  // Can be called without the lock, so it does not wait for executions.
+  bool IsMethodLoaded(const std::string& name) const;
+
+  // Return the method of |name|, which is loaded when necessary.
+  er::Result<er::Method*> GetMethod(const std::string& name);
+
+  // Execute the method whose inputs have been set.
+  er::Error Run(er::Method* method);
+
+  // Set inputs, execute the method and return its outputs. The stages are
+  // recorded to |timer| when it is not null.
+  er::Result<std::vector<er::EValue>> Execute(
+      er::Method* method,
+      const std::vector<er::EValue>& inputs,
+      CallTimer* timer = nullptr);
+
+  // The lock must be held when accessing the methods, as the sync APIs can run
+  // on JS thread when the queue is running a task.
+  std::mutex& mutex() { return mutex_; }
+
+  WorkQueue* queue() { return &queue_; }
+  Profiler* profiler() { return profiler_.get(); }
+
+ private:
+  struct MethodHolder {
+    std::vector<std::vector<uint8_t>> planned_buffers;
+    std::vector<er::Span<uint8_t>> planned_spans;
+    std::unique_ptr<er::HierarchicalAllocator> planned_memory;
+    std::unique_ptr<er::MemoryManager> memory_manager;
+    std::unique_ptr<er::Method> method;
+  };
+
+  const std::shared_ptr<LoadedProgram> program_;
+  const bool single_threaded_;
+  // Must outlive the methods.
+  std::unique_ptr<Profiler> profiler_;
+  ee::MallocMemoryAllocator method_allocator_;
+  ee::MallocMemoryAllocator temp_allocator_;
+  std::unordered_map<std::string, MethodHolder> methods_;
+  // Names of the loaded methods, which are read without the replica's lock.
+  mutable std::mutex names_mutex_;
+  std::unordered_set<std::string> method_names_;
+
+  std::mutex mutex_;
+  // Must be destroyed before the methods.
+  WorkQueue queue_;
+};
+
+}  // namespace etjs
+
+#endif  // SRC_REPLICA_H_
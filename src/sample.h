@@ -1,14 +1,36 @@
 #ifndef SRC_SAMPLE_H_
 #define SRC_SAMPLE_H_
 
-#include <stddef.h>
+#include <kizunapi.h>
+
+#include <vector>
+
+#include "src/sampling.h"
 
 namespace etjs {
 
 class Tensor;
 
-size_t Sample(Tensor* tensor, float temperature, float top_p);
+size_t Sample(Tensor* tensor, const SamplingOptions& options);
+
+// Sample a token from each row of the [B, N] tensor, and return the tokens in
+// a new tensor of |dtype|.
+Tensor* SampleBatch(napi_env env,
+                    Tensor* tensor,
+                    const std::vector<SamplingOptions>& options,
+                    ea::ScalarType dtype);
 
 }  // namespace etjs
 
+namespace ki {
+
+template<>
+struct Type<etjs::SamplingOptions> {
+  static constexpr const char* name = "SamplingOptions";
+  static std::optional<etjs::SamplingOptions> FromNode(napi_env env,
+                                                       napi_value value);
+};
+
+}  // namespace ki
+
 #endif  // SRC_SAMPLE_H_
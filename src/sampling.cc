@@ -0,0 +1,215 @@
+#include "src/sampling.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+
+#include "src/philox.h"
+#include "src/softmax.h"
+#include "src/thread_pool.h"
+
+namespace er = executorch::runtime;
+
+namespace etjs {
+
+namespace {
+
+// The min number of logits in a batch to sample rows in parallel.
+constexpr size_t kMinParallelBatchSize = 1 << 16;
+
+struct ProbIndex {
+  float prob;
+  size_t index;
+};
+
+template<typename T>
+size_t SampleArgMax(const T* probs, size_t size) {
+  size_t max_i = 0;
+  T max_p = probs[0];
+  for (size_t i = 1; i < size; i++) {
+    if (probs[i] > max_p) {
+      max_i = i;
+      max_p = probs[i];
+    }
+  }
+  return max_i;
+}
+
+size_t SampleMult(const float* probs, size_t size, float coin) {
+  float cdf = 0;
+  for (size_t i = 0; i < size; i++) {
+    cdf += probs[i];
+    if (coin < cdf)
+      return i;
+  }
+  return size - 1;
+}
+
+// Sample from the first |size| candidates, whose probs are not normalized.
+size_t SampleCandidates(const ProbIndex* candidates, size_t size, float coin) {
+  float mass = 0;
+  for (size_t i = 0; i < size; i++)
+    mass += candidates[i].prob;
+  float r = coin * mass;
+  float cdf = 0;
+  for (size_t i = 0; i < size; i++) {
+    cdf += candidates[i].prob;
+    if (r < cdf)
+      return candidates[i].index;
+  }
+  return candidates[size - 1].index;
+}
+
+// Bucket of the prob, larger probs are in larger buckets. The bits of positive
+// floats keep their order, so the exponent and 2 bits of mantissa are used.
+inline uint32_t GetProbBucket(float prob) {
+  uint32_t bits;
+  std::memcpy(&bits, &prob, sizeof(bits));
+  return bits >> 21;
+}
+
+// Move the smallest set of candidates whose probs add up to more than
+// |threshold| to the front, and return its size. Instead of sorting all the
+// candidates, the probs are summed by buckets to find the bucket where the
+// threshold is crossed, and only the candidates in and above it are sorted.
+size_t SelectTopP(std::vector<ProbIndex>& candidates,
+                  size_t size,
+                  float threshold) {
+  std::array<float, 1024> mass = {};
+  for (size_t i = 0; i < size; i++)
+    mass[GetProbBucket(candidates[i].prob)] += candidates[i].prob;
+  uint32_t bucket = 0;
+  float cumulative_prob = 0;
+  for (size_t b = mass.size(); b-- > 0;) {
+    cumulative_prob += mass[b];
+    if (cumulative_prob > threshold) {
+      bucket = b;
+      break;
+    }
+  }
+  auto head_end = std::partition(
+      candidates.begin(), candidates.begin() + size,
+      [bucket](const ProbIndex& p) { return GetProbBucket(p.prob) >= bucket; });
+  std::sort(candidates.begin(), head_end,
+            [](const ProbIndex& a, const ProbIndex& b) {
+              return a.prob > b.prob;
+            });
+  size_t head_size = head_end - candidates.begin();
+  cumulative_prob = 0;
+  for (size_t i = 0; i < head_size; i++) {
+    cumulative_prob += candidates[i].prob;
+    if (cumulative_prob > threshold)
+      return i + 1;
+  }
+  return head_size;
+}
+
+float RandomF32(const SamplingOptions& options) {
+  Philox* generator = options.generator ? options.generator.get()
+                                        : Philox::GetDefault();
+  return generator->NextFloat();
+}
+
+size_t SampleWithCoin(ea::ScalarType dtype,
+                      const void* data,
+                      size_t size,
+                      const SamplingOptions& options,
+                      float coin) {
+  size_t ret = 0;
+  if (options.temperature == 0 || size == 1) {
+    ET_SWITCH_REALHBBF16_TYPES(dtype, nullptr, "sample", CTYPE, [&] {
+      ret = SampleArgMax(static_cast<const CTYPE*>(data), size);
+    });
+    return ret;
+  }
+
+  // The probs are always computed in float32, and the buffers are reused to
+  // avoid allocations for every token.
+  thread_local std::vector<float> probs;
+  thread_local std::vector<ProbIndex> candidates;
+  probs.resize(size);
+  Softmax(dtype, data, size, options.temperature, probs.data());
+
+  bool use_top_p = options.top_p > 0 && options.top_p < 1;
+  bool use_top_k = options.top_k > 0 && options.top_k < size;
+  bool use_min_p = options.min_p > 0;
+  if (!use_top_p && !use_top_k && !use_min_p)
+    return SampleMult(probs.data(), size, coin);
+
+  // Tokens below the cutoff can not be selected. When top-p is the only
+  // filter, tokens with probs below (1 - top_p) / (size - 1) can never be in
+  // the nucleus.
+  float cutoff = 0;
+  if (use_min_p)
+    cutoff = options.min_p * *std::max_element(probs.begin(), probs.end());
+  else if (!use_top_k)
+    cutoff = (1.0f - options.top_p) / (size - 1);
+  candidates.clear();
+  for (size_t i = 0; i < size; i++) {
+    if (probs[i] >= cutoff)
+      candidates.push_back({probs[i], i});
+  }
+  if (candidates.empty())
+    return SampleArgMax(probs.data(), size);
+
+  // Move the k most likely tokens to the front without sorting them.
+  size_t n = candidates.size();
+  if (use_top_k && options.top_k < n) {
+    std::nth_element(candidates.begin(),
+                     candidates.begin() + options.top_k - 1,
+                     candidates.end(),
+                     [](const ProbIndex& a, const ProbIndex& b) {
+                       return a.prob > b.prob;
+                     });
+    n = options.top_k;
+  }
+
+  // The top-p is applied on the probs renormalized over remaining tokens.
+  if (use_top_p) {
+    float mass = 0;
+    for (size_t i = 0; i < n; i++)
+      mass += candidates[i].prob;
+    n = SelectTopP(candidates, n, options.top_p * mass);
+  }
+
+  return SampleCandidates(candidates.data(), n, coin);
+}
+
+}  // namespace
+
+size_t SampleLogits(ea::ScalarType dtype,
+                    const void* data,
+                    size_t size,
+                    const SamplingOptions& options) {
+  return SampleWithCoin(dtype, data, size, options, RandomF32(options));
+}
+
+void SampleLogitsBatch(ea::ScalarType dtype,
+                       const void* data,
+                       size_t batch,
+                       size_t size,
+                       size_t row_stride,
+                       const std::vector<SamplingOptions>& options,
+                       int64_t* tokens) {
+  // The random numbers are drawn on the calling thread, so the results do not
+  // depend on how rows are scheduled.
+  std::vector<float> coins(batch);
+  for (size_t i = 0; i < batch; ++i)
+    coins[i] = RandomF32(options[i]);
+  size_t row_bytes = row_stride * er::elementSize(dtype);
+  auto sample_row = [&](size_t i) {
+    const void* row = static_cast<const uint8_t*>(data) + i * row_bytes;
+    tokens[i] = SampleWithCoin(dtype, row, size, options[i], coins[i]);
+  };
+  // Small batches are not worth the cost of waking threads.
+  if (batch > 1 && batch * size >= kMinParallelBatchSize) {
+    ThreadPool::GetDefault()->ParallelFor(batch, sample_row);
+  } else {
+    for (size_t i = 0; i < batch; ++i)
+      sample_row(i);
+  }
+}
+
+}  // namespace etjs
@@ -0,0 +1,45 @@
+#ifndef SRC_SAMPLING_H_
+#define SRC_SAMPLING_H_
+
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+
+#include <memory>
+#include <vector>
+
+namespace ea = executorch::aten;
+
+namespace etjs {
+
+class Philox;
+
+struct SamplingOptions {
+  float temperature = 1;
+  // Keep the smallest set of tokens whose probabilities add up to |top_p|.
+  float top_p = 1;
+  // Keep the |top_k| most likely tokens, 0 means no limit.
+  size_t top_k = 0;
+  // Keep tokens whose probabilities are at least |min_p| of the max one.
+  float min_p = 0;
+  // The default generator is used when not set.
+  std::shared_ptr<Philox> generator;
+};
+
+// Sample from the |size| logits stored in |data| of |dtype|.
+size_t SampleLogits(ea::ScalarType dtype,
+                    const void* data,
+                    size_t size,
+                    const SamplingOptions& options);
+
+// Sample from the |batch| rows of |size| logits, which are |row_stride|
+// elements apart. Rows are sampled in parallel when the batch is large.
+void SampleLogitsBatch(ea::ScalarType dtype,
+                       const void* data,
+                       size_t batch,
+                       size_t size,
+                       size_t row_stride,
+                       const std::vector<SamplingOptions>& options,
+                       int64_t* tokens);
+
+}  // namespace etjs
+
+#endif  // SRC_SAMPLING_H_
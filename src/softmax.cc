@@ -0,0 +1,355 @@
+#include "src/softmax.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define ETJS_SOFTMAX_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define ETJS_SOFTMAX_NEON
+#endif
+
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+
+namespace etjs {
+
+namespace {
+
+// The kernels compute exp((x - max) * scale) in one pass over the logits, with
+// half and bfloat16 widened to float32 when loaded.
+template<typename T>
+using Kernel = void (*)(const T* x, size_t size, float scale, float* probs);
+
+struct Kernels {
+  const char* name;
+  Kernel<float> f32;
+  Kernel<ea::Half> f16;
+  Kernel<ea::BFloat16> bf16;
+};
+
+template<typename T>
+void SoftmaxScalar(const T* x, size_t size, float scale, float* probs) {
+  float max_val = -std::numeric_limits<float>::infinity();
+  for (size_t i = 0; i < size; ++i)
+    max_val = std::max(max_val, static_cast<float>(x[i]));
+  float sum = 0;
+  for (size_t i = 0; i < size; ++i) {
+    probs[i] = std::exp((static_cast<float>(x[i]) - max_val) * scale);
+    sum += probs[i];
+  }
+  float inv_sum = 1.0f / sum;
+  for (size_t i = 0; i < size; ++i)
+    probs[i] *= inv_sum;
+}
+
+#if defined(ETJS_SOFTMAX_X86) || defined(ETJS_SOFTMAX_NEON)
+
+// Coefficients of the exp approximation used by Cephes, the inputs are never
+// positive so only the lower bound is clamped.
+constexpr float kExpLowerBound = -87.3f;
+constexpr float kLog2e = 1.44269504088896341f;
+constexpr float kLn2Hi = 0.693359375f;
+constexpr float kLn2Lo = -2.12194440e-4f;
+constexpr float kExpP0 = 1.9875691500e-4f;
+constexpr float kExpP1 = 1.3981999507e-3f;
+constexpr float kExpP2 = 8.3334519073e-3f;
+constexpr float kExpP3 = 4.1665795894e-2f;
+constexpr float kExpP4 = 1.6666665459e-1f;
+constexpr float kExpP5 = 5.0000001201e-1f;
+
+#endif
+
+#if defined(ETJS_SOFTMAX_X86)
+
+#define ETJS_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#define ETJS_TARGET_AVX512 __attribute__((target("avx512f")))
+
+ETJS_TARGET_AVX2 inline __m256 LoadAvx2(const float* p) {
+  return _mm256_loadu_ps(p);
+}
+
+ETJS_TARGET_AVX2 inline __m256 LoadAvx2(const ea::Half* p) {
+  return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+ETJS_TARGET_AVX2 inline __m256 LoadAvx2(const ea::BFloat16* p) {
+  __m256i i = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+  return _mm256_castsi256_ps(_mm256_slli_epi32(i, 16));
+}
+
+ETJS_TARGET_AVX2 inline __m256 ExpAvx2(__m256 x) {
+  x = _mm256_max_ps(x, _mm256_set1_ps(kExpLowerBound));
+  __m256 fx = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(kLog2e)),
+                              _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(kLn2Hi), x);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(kLn2Lo), x);
+  __m256 y = _mm256_set1_ps(kExpP0);
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP1));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP2));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP3));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP4));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP5));
+  y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x),
+                      _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+  __m256i n = _mm256_add_epi32(_mm256_cvtps_epi32(fx), _mm256_set1_epi32(127));
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(n, 23)));
+}
+
+ETJS_TARGET_AVX2 inline float ReduceMaxAvx2(__m256 v) {
+  __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+  m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+  return _mm_cvtss_f32(m);
+}
+
+ETJS_TARGET_AVX2 inline float ReduceAddAvx2(__m256 v) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+template<typename T>
+ETJS_TARGET_AVX2 void SoftmaxAvx2(const T* x,
+                                  size_t size,
+                                  float scale,
+                                  float* probs) {
+  constexpr size_t kWidth = 8;
+  size_t i = 0;
+  __m256 vmax = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+  for (; i + kWidth <= size; i += kWidth)
+    vmax = _mm256_max_ps(vmax, LoadAvx2(x + i));
+  float max_val = ReduceMaxAvx2(vmax);
+  for (; i < size; ++i)
+    max_val = std::max(max_val, static_cast<float>(x[i]));
+  __m256 vscale = _mm256_set1_ps(scale);
+  __m256 vbias = _mm256_set1_ps(-max_val * scale);
+  __m256 vsum = _mm256_setzero_ps();
+  for (i = 0; i + kWidth <= size; i += kWidth) {
+    __m256 e = ExpAvx2(_mm256_fmadd_ps(LoadAvx2(x + i), vscale, vbias));
+    _mm256_storeu_ps(probs + i, e);
+    vsum = _mm256_add_ps(vsum, e);
+  }
+  float sum = ReduceAddAvx2(vsum);
+  for (; i < size; ++i) {
+    probs[i] = std::exp((static_cast<float>(x[i]) - max_val) * scale);
+    sum += probs[i];
+  }
+  float inv_sum = 1.0f / sum;
+  __m256 vinv_sum = _mm256_set1_ps(inv_sum);
+  for (i = 0; i + kWidth <= size; i += kWidth)
+    _mm256_storeu_ps(probs + i,
+                     _mm256_mul_ps(_mm256_loadu_ps(probs + i), vinv_sum));
+  for (; i < size; ++i)
+    probs[i] *= inv_sum;
+}
+
+ETJS_TARGET_AVX512 inline __m512 LoadAvx512(const float* p) {
+  return _mm512_loadu_ps(p);
+}
+
+ETJS_TARGET_AVX512 inline __m512 LoadAvx512(const ea::Half* p) {
+  return _mm512_cvtph_ps(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+}
+
+ETJS_TARGET_AVX512 inline __m512 LoadAvx512(const ea::BFloat16* p) {
+  __m512i i = _mm512_cvtepu16_epi32(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+  return _mm512_castsi512_ps(_mm512_slli_epi32(i, 16));
+}
+
+ETJS_TARGET_AVX512 inline __m512 ExpAvx512(__m512 x) {
+  x = _mm512_max_ps(x, _mm512_set1_ps(kExpLowerBound));
+  __m512 fx = _mm512_roundscale_ps(
+      _mm512_mul_ps(x, _mm512_set1_ps(kLog2e)),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(kLn2Hi), x);
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(kLn2Lo), x);
+  __m512 y = _mm512_set1_ps(kExpP0);
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP1));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP2));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP3));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP4));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP5));
+  y = _mm512_fmadd_ps(y, _mm512_mul_ps(x, x),
+                      _mm512_add_ps(x, _mm512_set1_ps(1.0f)));
+  __m512i n = _mm512_add_epi32(_mm512_cvtps_epi32(fx), _mm512_set1_epi32(127));
+  return _mm512_mul_ps(y, _mm512_castsi512_ps(_mm512_slli_epi32(n, 23)));
+}
+
+template<typename T>
+ETJS_TARGET_AVX512 void SoftmaxAvx512(const T* x,
+                                      size_t size,
+                                      float scale,
+                                      float* probs) {
+  constexpr size_t kWidth = 16;
+  size_t i = 0;
+  __m512 vmax = _mm512_set1_ps(-std::numeric_limits<float>::infinity());
+  for (; i + kWidth <= size; i += kWidth)
+    vmax = _mm512_max_ps(vmax, LoadAvx512(x + i));
+  float max_val = _mm512_reduce_max_ps(vmax);
+  for (; i < size; ++i)
+    max_val = std::max(max_val, static_cast<float>(x[i]));
+  __m512 vscale = _mm512_set1_ps(scale);
+  __m512 vbias = _mm512_set1_ps(-max_val * scale);
+  __m512 vsum = _mm512_setzero_ps();
+  for (i = 0; i + kWidth <= size; i += kWidth) {
+    __m512 e = ExpAvx512(_mm512_fmadd_ps(LoadAvx512(x + i), vscale, vbias));
+    _mm512_storeu_ps(probs + i, e);
+    vsum = _mm512_add_ps(vsum, e);
+  }
+  float sum = _mm512_reduce_add_ps(vsum);
+  for (; i < size; ++i) {
+    probs[i] = std::exp((static_cast<float>(x[i]) - max_val) * scale);
+    sum += probs[i];
+  }
+  float inv_sum = 1.0f / sum;
+  __m512 vinv_sum = _mm512_set1_ps(inv_sum);
+  for (i = 0; i + kWidth <= size; i += kWidth)
+    _mm512_storeu_ps(probs + i,
+                     _mm512_mul_ps(_mm512_loadu_ps(probs + i), vinv_sum));
+  for (; i < size; ++i)
+    probs[i] *= inv_sum;
+}
+
+#endif  // defined(ETJS_SOFTMAX_X86)
+
+#if defined(ETJS_SOFTMAX_NEON)
+
+inline float32x4_t LoadNeon(const float* p) {
+  return vld1q_f32(p);
+}
+
+inline float32x4_t LoadNeon(const ea::Half* p) {
+  return vcvt_f32_f16(vreinterpret_f16_u16(
+      vld1_u16(reinterpret_cast<const uint16_t*>(p))));
+}
+
+inline float32x4_t LoadNeon(const ea::BFloat16* p) {
+  return vreinterpretq_f32_u32(
+      vshll_n_u16(vld1_u16(reinterpret_cast<const uint16_t*>(p)), 16));
+}
+
+inline float32x4_t ExpNeon(float32x4_t x) {
+  x = vmaxq_f32(x, vdupq_n_f32(kExpLowerBound));
+  float32x4_t fx = vrndnq_f32(vmulq_f32(x, vdupq_n_f32(kLog2e)));
+  x = vfmsq_f32(x, fx, vdupq_n_f32(kLn2Hi));
+  x = vfmsq_f32(x, fx, vdupq_n_f32(kLn2Lo));
+  float32x4_t y = vdupq_n_f32(kExpP0);
+  y = vfmaq_f32(vdupq_n_f32(kExpP1), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP2), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP3), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP4), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpP5), y, x);
+  y = vfmaq_f32(vaddq_f32(x, vdupq_n_f32(1.0f)), y, vmulq_f32(x, x));
+  int32x4_t n = vaddq_s32(vcvtq_s32_f32(fx), vdupq_n_s32(127));
+  return vmulq_f32(y, vreinterpretq_f32_s32(vshlq_n_s32(n, 23)));
+}
+
+template<typename T>
+void SoftmaxNeon(const T* x, size_t size, float scale, float* probs) {
+  constexpr size_t kWidth = 4;
+  size_t i = 0;
+  float32x4_t vmax = vdupq_n_f32(-std::numeric_limits<float>::infinity());
+  for (; i + kWidth <= size; i += kWidth)
+    vmax = vmaxq_f32(vmax, LoadNeon(x + i));
+  float max_val = vmaxvq_f32(vmax);
+  for (; i < size; ++i)
+    max_val = std::max(max_val, static_cast<float>(x[i]));
+  float32x4_t vscale = vdupq_n_f32(scale);
+  float32x4_t vbias = vdupq_n_f32(-max_val * scale);
+  float32x4_t vsum = vdupq_n_f32(0);
+  for (i = 0; i + kWidth <= size; i += kWidth) {
+    float32x4_t e = ExpNeon(vfmaq_f32(vbias, LoadNeon(x + i), vscale));
+    vst1q_f32(probs + i, e);
+    vsum = vaddq_f32(vsum, e);
+  }
+  float sum = vaddvq_f32(vsum);
+  for (; i < size; ++i) {
+    probs[i] = std::exp((static_cast<float>(x[i]) - max_val) * scale);
+    sum += probs[i];
+  }
+  float inv_sum = 1.0f / sum;
+  float32x4_t vinv_sum = vdupq_n_f32(inv_sum);
+  for (i = 0; i + kWidth <= size; i += kWidth)
+    vst1q_f32(probs + i, vmulq_f32(vld1q_f32(probs + i), vinv_sum));
+  for (; i < size; ++i)
+    probs[i] *= inv_sum;
+}
+
+#endif  // defined(ETJS_SOFTMAX_NEON)
+
+Kernels PickKernels() {
+  if (!std::getenv("ETJS_DISABLE_SIMD")) {
+#if defined(ETJS_SOFTMAX_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return {"avx512",
+              &SoftmaxAvx512<float>,
+              &SoftmaxAvx512<ea::Half>,
+              &SoftmaxAvx512<ea::BFloat16>};
+    }
+    if (__builtin_cpu_supports("avx2") &&
+        __builtin_cpu_supports("fma") &&
+        __builtin_cpu_supports("f16c")) {
+      return {"avx2",
+              &SoftmaxAvx2<float>,
+              &SoftmaxAvx2<ea::Half>,
+              &SoftmaxAvx2<ea::BFloat16>};
+    }
+#elif defined(ETJS_SOFTMAX_NEON)
+    return {"neon",
+            &SoftmaxNeon<float>,
+            &SoftmaxNeon<ea::Half>,
+            &SoftmaxNeon<ea::BFloat16>};
+#endif
+  }
+  return {"scalar",
+          &SoftmaxScalar<float>,
+          &SoftmaxScalar<ea::Half>,
+          &SoftmaxScalar<ea::BFloat16>};
+}
+
+const Kernels& GetKernels() {
+  static const Kernels kernels = PickKernels();
+  return kernels;
+}
+
+}  // namespace
+
+void Softmax(ea::ScalarType dtype,
+             const void* logits,
+             size_t size,
+             float temperature,
+             float* probs) {
+  const Kernels& kernels = GetKernels();
+  float scale = 1.0f / temperature;
+  switch (dtype) {
+    case ea::ScalarType::Float:
+      kernels.f32(static_cast<const float*>(logits), size, scale, probs);
+      break;
+    case ea::ScalarType::Half:
+      kernels.f16(static_cast<const ea::Half*>(logits), size, scale, probs);
+      break;
+    case ea::ScalarType::BFloat16:
+      kernels.bf16(static_cast<const ea::BFloat16*>(logits), size, scale,
+                   probs);
+      break;
+    default:
+      ET_SWITCH_REALHBBF16_TYPES(dtype, nullptr, "softmax", CTYPE, [&] {
+        SoftmaxScalar(static_cast<const CTYPE*>(logits), size, scale, probs);
+      });
+  }
+}
+
+const char* GetSoftmaxKernelName() {
+  return GetKernels().name;
+}
+
+}  // namespace etjs
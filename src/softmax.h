@@ -0,0 +1,25 @@
+#ifndef SRC_SOFTMAX_H_
+#define SRC_SOFTMAX_H_
+
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+
+namespace ea = executorch::aten;
+
+namespace etjs {
+
+// Write softmax(logits / temperature) of the |size| logits of |dtype| to
+// |probs| as float32. The temperature must be positive.
+void Softmax(ea::ScalarType dtype,
+             const void* logits,
+             size_t size,
+             float temperature,
+             float* probs);
+
+// Return the name of kernel picked for the CPU, which is one of "avx512",
+// "avx2", "neon" and "scalar". Setting the ETJS_DISABLE_SIMD env forces the
+// scalar kernel.
+const char* GetSoftmaxKernelName();
+
+}  // namespace etjs
+
+#endif  // SRC_SOFTMAX_H_
@@ -0,0 +1,192 @@
+#include "src/stats.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace etjs {
+
+namespace {
+
+// Return the bucket of |value|, the first 2 powers of 2 are not split.
+size_t GetBucket(uint64_t value, size_t sub_buckets) {
+  if (value < sub_buckets)
+    return value;
+  size_t exponent = std::bit_width(value) - 1;
+  size_t shift = exponent - std::bit_width(sub_buckets - 1);
+  return exponent * sub_buckets + ((value >> shift) & (sub_buckets - 1));
+}
+
+// Return the middle of the range covered by |bucket|.
+uint64_t GetBucketValue(size_t bucket, size_t sub_buckets) {
+  if (bucket < sub_buckets)
+    return bucket;
+  size_t exponent = bucket / sub_buckets;
+  size_t shift = exponent - std::bit_width(sub_buckets - 1);
+  uint64_t lower = (sub_buckets + bucket % sub_buckets) << shift;
+  return lower + (uint64_t(1) << shift) / 2;
+}
+
+double ToMilliseconds(uint64_t nanoseconds) {
+  return nanoseconds / 1e6;
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() {
+  Reset();
+}
+
+LatencyHistogram::~LatencyHistogram() = default;
+
+void LatencyHistogram::Add(uint64_t nanoseconds) {
+  buckets_[GetBucket(nanoseconds, kSubBuckets)].fetch_add(
+      1, std::memory_order_relaxed);
+  sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (nanoseconds > max &&
+         !max_.compare_exchange_weak(max, nanoseconds,
+                                     std::memory_order_relaxed)) {}
+}
+
+LatencyHistogram::Summary LatencyHistogram::GetSummary() const {
+  Summary summary;
+  // Read the count from buckets so the percentiles are consistent with them.
+  summary.count = 0;
+  for (const auto& bucket : buckets_)
+    summary.count += bucket.load(std::memory_order_relaxed);
+  summary.sum = sum_.load(std::memory_order_relaxed);
+  summary.p50 = GetPercentile(0.5, summary.count);
+  summary.p90 = GetPercentile(0.9, summary.count);
+  summary.p99 = GetPercentile(0.99, summary.count);
+  summary.max = max_.load(std::memory_order_relaxed);
+  return summary;
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& bucket : buckets_)
+    bucket.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetPercentile(double q, uint64_t count) const {
+  if (count == 0)
+    return 0;
+  // The rank of the value, starting from 1.
+  uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(q * count + 0.5), 1);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    // The middle of bucket can be larger than any recorded value.
+    if (seen >= rank)
+      return std::min(GetBucketValue(i, kSubBuckets), max);
+  }
+  return max;
+}
+
+ExecutionStats::ExecutionStats() = default;
+
+ExecutionStats::~ExecutionStats() = default;
+
+void ExecutionStats::AddDuration(Stage stage, uint64_t nanoseconds) {
+  stages_[stage].Add(nanoseconds);
+}
+
+void ExecutionStats::AddCall(bool ok,
+                             uint64_t copied_bytes,
+                             uint64_t allocations) {
+  calls_.fetch_add(1, std::memory_order_relaxed);
+  if (!ok)
+    errors_.fetch_add(1, std::memory_order_relaxed);
+  copied_bytes_.fetch_add(copied_bytes, std::memory_order_relaxed);
+  allocations_.fetch_add(allocations, std::memory_order_relaxed);
+}
+
+ExecutionStats::Snapshot ExecutionStats::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.calls = calls_.load(std::memory_order_relaxed);
+  snapshot.errors = errors_.load(std::memory_order_relaxed);
+  snapshot.copied_bytes = copied_bytes_.load(std::memory_order_relaxed);
+  snapshot.allocations = allocations_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kNumStages; ++i)
+    snapshot.stages[i] = stages_[i].GetSummary();
+  return snapshot;
+}
+
+void ExecutionStats::Reset() {
+  for (auto& stage : stages_)
+    stage.Reset();
+  calls_.store(0, std::memory_order_relaxed);
+  errors_.store(0, std::memory_order_relaxed);
+  copied_bytes_.store(0, std::memory_order_relaxed);
+  allocations_.store(0, std::memory_order_relaxed);
+}
+
+CallTimer::CallTimer(std::shared_ptr<ExecutionStats> stats)
+    : stats_(std::move(stats)),
+      start_(std::chrono::steady_clock::now()),
+      last_(start_) {}
+
+CallTimer::~CallTimer() = default;
+
+void CallTimer::Mark(ExecutionStats::Stage stage) {
+  auto now = std::chrono::steady_clock::now();
+  stats_->AddDuration(stage, std::chrono::nanoseconds(now - last_).count());
+  last_ = now;
+}
+
+void CallTimer::Finish() {
+  auto now = std::chrono::steady_clock::now();
+  stats_->AddDuration(ExecutionStats::kTotal,
+                      std::chrono::nanoseconds(now - start_).count());
+  stats_->AddCall(ok_, copied_bytes_, allocations_);
+}
+
+}  // namespace etjs
+
+namespace ki {
+
+namespace {
+
+napi_value SummaryToNode(napi_env env,
+                         const etjs::LatencyHistogram::Summary& summary) {
+  napi_value result = CreateObject(env);
+  Set(env, result,
+      "count", static_cast<double>(summary.count),
+      "sumMs", etjs::ToMilliseconds(summary.sum),
+      "p50Ms", etjs::ToMilliseconds(summary.p50),
+      "p90Ms", etjs::ToMilliseconds(summary.p90),
+      "p99Ms", etjs::ToMilliseconds(summary.p99),
+      "maxMs", etjs::ToMilliseconds(summary.max));
+  return result;
+}
+
+}  // namespace
+
+// static
+napi_status Type<etjs::ExecutionStats::Snapshot>::ToNode(
+    napi_env env,
+    const etjs::ExecutionStats::Snapshot& value,
+    napi_value* result) {
+  using Stats = etjs::ExecutionStats;
+  napi_value stages = CreateObject(env);
+  Set(env, stages,
+      "queue", SummaryToNode(env, value.stages[Stats::kQueue]),
+      "inputs", SummaryToNode(env, value.stages[Stats::kInputs]),
+      "execute", SummaryToNode(env, value.stages[Stats::kExecute]),
+      "outputs", SummaryToNode(env, value.stages[Stats::kOutputs]),
+      "reply", SummaryToNode(env, value.stages[Stats::kReply]),
+      "convert", SummaryToNode(env, value.stages[Stats::kConvert]),
+      "total", SummaryToNode(env, value.stages[Stats::kTotal]));
+  *result = CreateObject(env);
+  Set(env, *result,
+      "calls", static_cast<double>(value.calls),
+      "errors", static_cast<double>(value.errors),
+      "copiedBytes", static_cast<double>(value.copied_bytes),
+      "allocations", static_cast<double>(value.allocations),
+      "stages", stages);
+  return napi_ok;
+}
+
+}  // namespace ki
@@ -0,0 +1,140 @@
+#ifndef SRC_STATS_H_
+#define SRC_STATS_H_
+
+#include <kizunapi.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace etjs {
+
+// A lock-free histogram of durations with log-scale buckets, each power of 2
+// is split into 4 buckets so percentiles are within 12.5% of real values.
+class LatencyHistogram {
+ public:
+  struct Summary {
+    uint64_t count;
+    // All values are in nanoseconds.
+    uint64_t sum;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t max;
+  };
+
+  LatencyHistogram();
+  ~LatencyHistogram();
+
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+  LatencyHistogram(const LatencyHistogram&) = delete;
+
+  void Add(uint64_t nanoseconds);
+  Summary GetSummary() const;
+  // Values added concurrently with reset may be partially kept.
+  void Reset();
+
+ private:
+  static constexpr size_t kSubBuckets = 4;
+  static constexpr size_t kNumBuckets = 64 * kSubBuckets;
+
+  uint64_t GetPercentile(double q, uint64_t count) const;
+
+  std::array<std::atomic<uint64_t>, kNumBuckets> buckets_;
+  std::atomic<uint64_t> sum_ = 0;
+  std::atomic<uint64_t> max_ = 0;
+};
+
+// The latency breakdown of calls to a module's methods.
+class ExecutionStats {
+ public:
+  enum Stage {
+    // Waiting in the replica's queue.
+    kQueue,
+    // Converting arguments and setting inputs.
+    kInputs,
+    // Running Method::execute.
+    kExecute,
+    // Reading outputs and copying them into caller's tensors or new ones.
+    kOutputs,
+    // Waiting for the JS thread to receive the result.
+    kReply,
+    // Converting outputs to JS.
+    kConvert,
+    kTotal,
+    kNumStages,
+  };
+
+  struct Snapshot {
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t copied_bytes;
+    uint64_t allocations;
+    std::array<LatencyHistogram::Summary, kNumStages> stages;
+  };
+
+  ExecutionStats();
+  ~ExecutionStats();
+
+  ExecutionStats& operator=(const ExecutionStats&) = delete;
+  ExecutionStats(const ExecutionStats&) = delete;
+
+  void AddDuration(Stage stage, uint64_t nanoseconds);
+  void AddCall(bool ok, uint64_t copied_bytes, uint64_t allocations);
+
+  Snapshot GetSnapshot() const;
+  void Reset();
+
+ private:
+  std::array<LatencyHistogram, kNumStages> stages_;
+  std::atomic<uint64_t> calls_ = 0;
+  std::atomic<uint64_t> errors_ = 0;
+  std::atomic<uint64_t> copied_bytes_ = 0;
+  std::atomic<uint64_t> allocations_ = 0;
+};
+
+// Time the stages of one call, which may run on different threads in order,
+// and add them to the stats when finished.
+class CallTimer {
+ public:
+  explicit CallTimer(std::shared_ptr<ExecutionStats> stats);
+  ~CallTimer();
+
+  CallTimer& operator=(const CallTimer&) = delete;
+  CallTimer(const CallTimer&) = delete;
+
+  // Record the time since last mark as the duration of |stage|.
+  void Mark(ExecutionStats::Stage stage);
+
+  void AddCopiedBytes(uint64_t bytes) { copied_bytes_ += bytes; }
+  void AddAllocation() { allocations_++; }
+  void SetFailed() { ok_ = false; }
+
+  // Record the total time and add the call to stats.
+  void Finish();
+
+ private:
+  std::shared_ptr<ExecutionStats> stats_;
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point last_;
+  uint64_t copied_bytes_ = 0;
+  uint64_t allocations_ = 0;
+  bool ok_ = true;
+};
+
+}  // namespace etjs
+
+namespace ki {
+
+template<>
+struct Type<etjs::ExecutionStats::Snapshot> {
+  static constexpr const char* name = "ExecutionStats";
+  static napi_status ToNode(napi_env env,
+                            const etjs::ExecutionStats::Snapshot& value,
+                            napi_value* result);
+};
+
+}  // namespace ki
+
+#endif  // SRC_STATS_H_
@@ -3,6 +3,8 @@
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
 
+#include <algorithm>
+#include <cstring>
 #include <numeric>
 
 #include "src/scalar.h"
@@ -39,7 +41,7 @@ std::vector<ea::StridesType> DefaultStrides(
 
 }  // namespace
 
-Tensor::Tensor(std::vector<uint8_t> data,
+Tensor::Tensor(PooledBuffer data,
                ea::ScalarType dtype,
                std::vector<ea::SizesType> shape,
                std::vector<ea::DimOrderType> dim_order,
@@ -74,12 +76,147 @@ Tensor::Tensor(Buffer data,
   ET_CHECK_MSG(data_.size >= nbytes(), "Tensor size exceeds data size.");
 }
 
-Tensor::~Tensor() = default;
+Tensor::~Tensor() {
+  Dispose();
+}
+
+// static
+std::unique_ptr<Tensor> Tensor::Copy(const ea::Tensor& tensor) {
+  PooledBuffer data(tensor.nbytes());
+  std::memcpy(data.data(), tensor.const_data_ptr(), tensor.nbytes());
+  return std::make_unique<Tensor>(
+      std::move(data),
+      tensor.scalar_type(),
+      std::vector<ea::SizesType>(tensor.sizes().begin(), tensor.sizes().end()),
+      std::vector<ea::DimOrderType>(tensor.dim_order().begin(),
+                                    tensor.dim_order().end()),
+      std::vector<ea::StridesType>(tensor.strides().begin(),
+                                   tensor.strides().end()));
+}
+
+void Tensor::ReportExternalMemory(napi_env env) {
+  if (env_ || !owns_data())
+    return;
+  env_ = env;
+  int64_t result;
+  napi_adjust_external_memory(env_, managed_data_.size(), &result);
+}
+
+void Tensor::Dispose() {
+  if (disposed_)
+    return;
+  disposed_ = true;
+  if (env_) {
+    int64_t result;
+    napi_adjust_external_memory(
+        env_, -static_cast<int64_t>(managed_data_.size()), &result);
+  }
+  managed_data_ = PooledBuffer();
+  data_ = Buffer{nullptr, 0};
+  impl_.set_data(nullptr);
+}
 
 }  // namespace etjs
 
 namespace {
 
+// Return the dtype whose elements have the same memory layout with the
+// elements of typed array.
+std::optional<ea::ScalarType> GetTypedArrayDType(napi_typedarray_type type) {
+  switch (type) {
+    case napi_int8_array:     return ea::ScalarType::Char;
+    case napi_uint8_array:
+    case napi_uint8_clamped_array:
+                              return ea::ScalarType::Byte;
+    case napi_int16_array:    return ea::ScalarType::Short;
+    case napi_int32_array:    return ea::ScalarType::Int;
+    case napi_float32_array:  return ea::ScalarType::Float;
+    case napi_float64_array:  return ea::ScalarType::Double;
+    case napi_bigint64_array: return ea::ScalarType::Long;
+    default:                  return std::nullopt;
+  }
+}
+
+// Return the bytes of one element of typed array, or 0 for unknown types.
+size_t GetTypedArrayElementSize(napi_typedarray_type type) {
+  switch (type) {
+    case napi_int8_array:
+    case napi_uint8_array:
+    case napi_uint8_clamped_array:
+      return 1;
+    case napi_int16_array:
+    case napi_uint16_array:
+      return 2;
+    case napi_int32_array:
+    case napi_uint32_array:
+    case napi_float32_array:
+      return 4;
+    case napi_float64_array:
+    case napi_bigint64_array:
+    case napi_biguint64_array:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+// Cast |length| elements to native type of |dtype| and write them to |out|.
+template<typename T>
+void CastElements(const void* data,
+                  size_t length,
+                  ea::ScalarType dtype,
+                  uint8_t* out) {
+  auto* elements = static_cast<const T*>(data);
+  ET_SWITCH_REALHBBF16_TYPES(dtype, nullptr, "etjs::Tensor", CTYPE, [&] {
+    // Plain loop of casts, which compilers vectorize for most types.
+    std::transform(elements,
+                   elements + length,
+                   reinterpret_cast<CTYPE*>(out),
+                   [](T element) { return static_cast<CTYPE>(element); });
+  });
+}
+
+// Cast the elements of typed array to |dtype| and write them to |out|.
+bool CastTypedArray(const etjs::TypedArray& array,
+                    ea::ScalarType dtype,
+                    uint8_t* out) {
+  switch (array.type) {
+    case napi_int8_array:
+      CastElements<int8_t>(array.data, array.length, dtype, out);
+      return true;
+    case napi_uint8_array:
+    case napi_uint8_clamped_array:
+      CastElements<uint8_t>(array.data, array.length, dtype, out);
+      return true;
+    case napi_int16_array:
+      CastElements<int16_t>(array.data, array.length, dtype, out);
+      return true;
+    case napi_uint16_array:
+      CastElements<uint16_t>(array.data, array.length, dtype, out);
+      return true;
+    case napi_int32_array:
+      CastElements<int32_t>(array.data, array.length, dtype, out);
+      return true;
+    case napi_uint32_array:
+      CastElements<uint32_t>(array.data, array.length, dtype, out);
+      return true;
+    case napi_float32_array:
+      CastElements<float>(array.data, array.length, dtype, out);
+      return true;
+    case napi_float64_array:
+      CastElements<double>(array.data, array.length, dtype, out);
+      return true;
+    case napi_bigint64_array:
+      CastElements<int64_t>(array.data, array.length, dtype, out);
+      return true;
+    case napi_biguint64_array:
+      CastElements<uint64_t>(array.data, array.length, dtype, out);
+      return true;
+    default:
+      return false;
+  }
+}
+
 // Convert the element at index in tensor to JS value.
 napi_value ElementToValue(etjs::Tensor* tensor, napi_env env, size_t index) {
   napi_value result = nullptr;
@@ -89,40 +226,128 @@ napi_value ElementToValue(etjs::Tensor* tensor, napi_env env, size_t index) {
   return result;
 }
 
-// Convert the tensor to array.
-napi_value TensorToArray(etjs::Tensor* tensor,
-                         napi_env env,
-                         size_t index = 0,
-                         size_t dim = 0) {
-  napi_value ret;
-  if (napi_create_array_with_length(env, tensor->shape()[dim], &ret) != napi_ok)
+// Convert the tensor to scalar.
+napi_value Item(etjs::Tensor* tensor, napi_env env) {
+  if (tensor->disposed()) {
+    ki::ThrowError(env, "The tensor has been disposed.");
     return nullptr;
-  for (size_t i = 0; i < tensor->shape()[dim]; ++i) {
-    if (dim == tensor->ndim() - 1) {
-      // The last dimension only has scalars.
-      napi_set_element(env, ret, i, ElementToValue(tensor, env, index));
+  }
+  if (tensor->size() != 1) {
+    ki::ThrowError(env, "item() can only be called on tensors of size 1.");
+    return nullptr;
+  }
+  return ElementToValue(tensor, env, 0);
+}
+
+// Return the type of TypedArray for storing elements of |dtype|.
+std::optional<napi_typedarray_type> GetTypedArrayType(ea::ScalarType dtype) {
+  switch (dtype) {
+    case ea::ScalarType::Byte:
+    case ea::ScalarType::Bool:   return napi_uint8_array;
+    case ea::ScalarType::Char:   return napi_int8_array;
+    case ea::ScalarType::Short:  return napi_int16_array;
+    case ea::ScalarType::Int:    return napi_int32_array;
+    case ea::ScalarType::Long:   return napi_bigint64_array;
+    case ea::ScalarType::Float:  return napi_float32_array;
+    case ea::ScalarType::Double: return napi_float64_array;
+    default:                     return std::nullopt;
+  }
+}
+
+// Whether the elements are stored contiguously in the order of shape.
+bool IsContiguous(const std::vector<ea::SizesType>& shape,
+                  const std::vector<ea::StridesType>& strides) {
+  ea::StridesType expected = 1;
+  for (size_t i = shape.size(); i-- > 0;) {
+    if (shape[i] != 1 && strides[i] != expected)
+      return false;
+    expected *= shape[i];
+  }
+  return true;
+}
+
+// Copy the elements of tensor to |out| in the order of shape.
+template<typename In, typename Out>
+void CopyElements(etjs::Tensor* tensor, Out* out) {
+  const In* data = tensor->data<In>();
+  auto cast = [](In element) { return static_cast<Out>(element); };
+  const auto& shape = tensor->shape();
+  const auto& strides = tensor->strides();
+  if (tensor->size() == 0)
+    return;
+  if (IsContiguous(shape, strides)) {
+    std::transform(data, data + tensor->size(), out, cast);
+    return;
+  }
+  // Copy the last dimension row by row, and walk the outer dimensions with a
+  // counter.
+  size_t ndim = shape.size();
+  size_t row_size = shape[ndim - 1];
+  ptrdiff_t row_stride = strides[ndim - 1];
+  std::vector<ea::SizesType> index(ndim - 1, 0);
+  ptrdiff_t offset = 0;
+  for (size_t r = 0; r < tensor->size() / row_size; ++r) {
+    const In* row = data + offset;
+    if (row_stride == 1) {
+      std::transform(row, row + row_size, out, cast);
     } else {
-      napi_set_element(env, ret, i, TensorToArray(tensor, env, index, dim + 1));
+      for (size_t i = 0; i < row_size; ++i)
+        out[i] = cast(row[i * row_stride]);
+    }
+    out += row_size;
+    for (size_t d = ndim - 1; d-- > 0;) {
+      offset += strides[d];
+      if (++index[d] < shape[d])
+        break;
+      offset -= strides[d] * shape[d];
+      index[d] = 0;
     }
-    index += tensor->strides()[dim];
   }
-  return ret;
 }
 
-// Convert the tensor to scalar.
-napi_value Item(etjs::Tensor* tensor, napi_env env) {
-  if (tensor->size() != 1) {
-    ki::ThrowError(env, "item() can only be called on tensors of size 1.");
+// Convert the tensor to a contiguous TypedArray with elements of |dtype|.
+napi_value ToTypedArray(etjs::Tensor* tensor,
+                        napi_env env,
+                        ea::ScalarType dtype) {
+  if (tensor->disposed()) {
+    ki::ThrowError(env, "The tensor has been disposed.");
     return nullptr;
   }
-  return ElementToValue(tensor, env, 0);
+  std::optional<napi_typedarray_type> type = GetTypedArrayType(dtype);
+  if (!type) {
+    ki::ThrowError(env, "There is no TypedArray for the dtype.");
+    return nullptr;
+  }
+  void* data;
+  napi_value buffer;
+  if (napi_create_arraybuffer(env, tensor->size() * er::elementSize(dtype),
+                              &data, &buffer) != napi_ok) {
+    return nullptr;
+  }
+  ET_SWITCH_REALHBBF16_TYPES(tensor->dtype(), nullptr, "toTypedArray", IN, [&] {
+    ET_SWITCH_REALHBBF16_TYPES(dtype, nullptr, "toTypedArray", OUT, [&] {
+      CopyElements<IN, OUT>(tensor, static_cast<OUT*>(data));
+    });
+  });
+  napi_value result;
+  if (napi_create_typedarray(env, *type, tensor->size(), buffer, 0,
+                             &result) != napi_ok) {
+    return nullptr;
+  }
+  return result;
 }
 
-// Convert the tensor to scalar or nested array.
-napi_value ToList(etjs::Tensor* tensor, napi_env env) {
-  if (tensor->ndim() == 0)
-    return Item(tensor, env);
-  return TensorToArray(tensor, env);
+// Free the tensor's data, and detach the JS |data| if it views the freed data.
+void Dispose(etjs::Tensor* tensor, napi_env env, napi_value data) {
+  void* ptr;
+  napi_value arraybuffer;
+  if (tensor->owns_data() &&
+      napi_get_typedarray_info(env, data, nullptr, nullptr, &ptr,
+                               &arraybuffer, nullptr) == napi_ok &&
+      ptr == tensor->buffer().data) {
+    napi_detach_arraybuffer(env, arraybuffer);
+  }
+  tensor->Dispose();
 }
 
 }  // namespace
@@ -153,17 +378,10 @@ struct Type<er::etensor::BFloat16> {
 napi_status Type<ea::Tensor>::ToNode(napi_env env,
                                      const ea::Tensor& value,
                                      napi_value* result) {
-  auto* data_ptr = static_cast<const uint8_t*>(value.const_data_ptr());
-  auto* tensor = new etjs::Tensor(
-      // The value data likely comes from inference output, which will get
-      // invalided soon and we must copy it.
-      std::vector<uint8_t>(data_ptr, data_ptr + value.nbytes()),
-      value.dtype(),
-      std::vector<ea::SizesType>(value.sizes().begin(), value.sizes().end()),
-      std::vector<ea::DimOrderType>(value.dim_order().begin(),
-                                    value.dim_order().end()),
-      std::vector<ea::StridesType>(value.strides().begin(),
-                                   value.strides().end()));
+  // The value data likely comes from inference output, which will get
+  // invalided soon and we must copy it.
+  etjs::Tensor* tensor = etjs::Tensor::Copy(value).release();
+  tensor->ReportExternalMemory(env);
   return ConvertToNode(env, tensor, result);
 }
 
@@ -171,7 +389,7 @@ napi_status Type<ea::Tensor>::ToNode(napi_env env,
 std::optional<ea::Tensor> Type<ea::Tensor>::FromNode(napi_env env,
                                                      napi_value value) {
   etjs::Tensor* tensor;
-  if (!Get(env, value, "holder", &tensor))
+  if (!Get(env, value, "holder", &tensor) || tensor->disposed())
     return std::nullopt;
   return ea::Tensor(tensor->impl());
 }
@@ -187,12 +405,28 @@ napi_status Type<etjs::Buffer>::ToNode(napi_env env,
 // static
 std::optional<etjs::Buffer> Type<etjs::Buffer>::FromNode(napi_env env,
                                                          napi_value value) {
-  void* data;
-  size_t size;
-  if (napi_get_buffer_info(env, value, &data, &size) != napi_ok)
+  // Read the TypedArray instead of Buffer, so views of SharedArrayBuffer
+  // can be passed.
+  auto array = FromNodeTo<etjs::TypedArray>(env, value);
+  if (!array)
     return std::nullopt;
-  // We are assuming the Buffer is kept alive in JS.
-  return etjs::Buffer{data, size};
+  size_t element_size = GetTypedArrayElementSize(array->type);
+  if (element_size == 0)
+    return std::nullopt;
+  // We are assuming the TypedArray is kept alive in JS.
+  return etjs::Buffer{array->data, array->length * element_size};
+}
+
+// static
+std::optional<etjs::TypedArray> Type<etjs::TypedArray>::FromNode(
+    napi_env env,
+    napi_value value) {
+  etjs::TypedArray array;
+  if (napi_get_typedarray_info(env, value, &array.type, &array.length,
+                               &array.data, nullptr, nullptr) != napi_ok) {
+    return std::nullopt;
+  }
+  return array;
 }
 
 // static
@@ -207,32 +441,51 @@ void Type<etjs::Tensor>::Define(napi_env env,
                    Property("strides", Getter(&etjs::Tensor::strides)),
                    Property("size", Getter(&etjs::Tensor::size)),
                    Property("nbytes", Getter(&etjs::Tensor::nbytes)),
-                   Property("itemsize", Getter(&etjs::Tensor::itemsize)));
+                   Property("itemsize", Getter(&etjs::Tensor::itemsize)),
+                   Property("disposed", Getter(&etjs::Tensor::disposed)));
   Set(env, prototype,
       "item", MemberFunction(&Item),
-      "tolist", MemberFunction(&ToList));
+      "toTypedArray", MemberFunction(&ToTypedArray),
+      "dispose", MemberFunction(&Dispose));
 }
 
 // static
 etjs::Tensor* Type<etjs::Tensor>::Constructor(
-    std::variant<etjs::Buffer, std::vector<double>> data,
+    napi_env env,
+    std::variant<etjs::TypedArray, std::vector<double>> data,
     ea::ScalarType dtype,
     std::vector<ea::SizesType> shape,
     std::vector<ea::DimOrderType> dim_order,
     std::vector<ea::StridesType> strides) {
-  // When a Buffer is passed, we assume the caller will keep it alive and we
-  // just read its content.
-  if (auto* b = std::get_if<etjs::Buffer>(&data); b) {
-    return new etjs::Tensor(*b,
-                            dtype,
-                            std::move(shape),
-                            std::move(dim_order),
-                            std::move(strides));
+  if (auto* a = std::get_if<etjs::TypedArray>(&data); a) {
+    // When a Uint8Array is passed, or the elements of typed array already have
+    // the layout of dtype, we assume the caller will keep it alive and we just
+    // read its content.
+    std::optional<ea::ScalarType> layout = GetTypedArrayDType(a->type);
+    if (a->type == napi_uint8_array || layout == dtype) {
+      etjs::Buffer buffer{a->data, a->length * er::elementSize(*layout)};
+      return new etjs::Tensor(buffer,
+                              dtype,
+                              std::move(shape),
+                              std::move(dim_order),
+                              std::move(strides));
+    }
+    // Otherwise cast the elements into a new buffer with one pass.
+    etjs::PooledBuffer casted_data(a->length * er::elementSize(dtype));
+    if (!CastTypedArray(*a, dtype, casted_data.data()))
+      return nullptr;
+    auto* tensor = new etjs::Tensor(std::move(casted_data),
+                                    dtype,
+                                    std::move(shape),
+                                    std::move(dim_order),
+                                    std::move(strides));
+    tensor->ReportExternalMemory(env);
+    return tensor;
   }
   // When an array of number is passed, cast elements to native type of dtype
   // and save them into a buffer.
   if (auto* v = std::get_if<std::vector<double>>(&data); v) {
-    std::vector<uint8_t> casted_data(v->size() * er::elementSize(dtype));
+    etjs::PooledBuffer casted_data(v->size() * er::elementSize(dtype));
     ET_SWITCH_REALHBBF16_TYPES(dtype, nullptr, "etjs::Tensor", CTYPE, [&] {
       std::transform(
           v->begin(),
@@ -240,11 +493,13 @@ etjs::Tensor* Type<etjs::Tensor>::Constructor(
           reinterpret_cast<CTYPE*>(casted_data.data()),
           [](double element) { return static_cast<CTYPE>(element); });
     });
-    return new etjs::Tensor(std::move(casted_data),
-                            dtype,
-                            std::move(shape),
-                            std::move(dim_order),
-                            std::move(strides));
+    auto* tensor = new etjs::Tensor(std::move(casted_data),
+                                    dtype,
+                                    std::move(shape),
+                                    std::move(dim_order),
+                                    std::move(strides));
+    tensor->ReportExternalMemory(env);
+    return tensor;
   }
   return nullptr;
 }
@@ -254,16 +509,4 @@ void Type<etjs::Tensor>::Destructor(etjs::Tensor* ptr) {
   // Memory is managed by TypeBridge<etjs::Tensor>::Finalize.
 }
 
-// Allow passing pointers of etjs::Tensor to JS, the code assumes we never free
-// the object in C++.
-template<>
-struct TypeBridge<etjs::Tensor> {
-  static inline etjs::Tensor* Wrap(etjs::Tensor* ptr) {
-    return ptr;
-  }
-  static inline void Finalize(etjs::Tensor* ptr) {
-    delete ptr;
-  }
-};
-
 }  // namespace ki
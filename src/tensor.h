@@ -4,6 +4,10 @@
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <kizunapi.h>
 
+#include <memory>
+
+#include "src/buffer_pool.h"
+
 namespace ea = executorch::aten;
 
 namespace etjs {
@@ -14,10 +18,17 @@ struct Buffer {
   size_t size;
 };
 
+// Intermediate type for reading the elements of a JS TypedArray.
+struct TypedArray {
+  napi_typedarray_type type;
+  void* data;
+  size_t length;
+};
+
 // Provide storage for tensor data.
 class Tensor {
  public:
-  Tensor(std::vector<uint8_t> data,
+  Tensor(PooledBuffer data,
          ea::ScalarType dtype,
          std::vector<ea::SizesType> shape,
          std::vector<ea::DimOrderType> dim_order = {},
@@ -29,6 +40,16 @@ class Tensor {
          std::vector<ea::StridesType> strides = {});
   ~Tensor();
 
+  // Copy the data and layout of |tensor| into a new tensor owning its data.
+  static std::unique_ptr<Tensor> Copy(const ea::Tensor& tensor);
+
+  // Report the size of managed data to V8 so GC knows the memory pressure,
+  // the size is reported back when the data is freed.
+  void ReportExternalMemory(napi_env env);
+
+  // Free the managed data immediately, the tensor can no longer be used.
+  void Dispose();
+
   ea::TensorImpl* impl() { return &impl_; }
 
   const Buffer& buffer() const { return data_; }
@@ -40,6 +61,8 @@ class Tensor {
   size_t size() const { return impl_.numel(); }
   size_t nbytes() const { return impl_.nbytes(); }
   size_t itemsize() const { return impl_.element_size(); }
+  bool owns_data() const { return managed_data_.data() != nullptr; }
+  bool disposed() const { return disposed_; }
 
   template<typename T>
   T* data() { return static_cast<T*>(data_.data); }
@@ -51,7 +74,10 @@ class Tensor {
   std::vector<ea::StridesType> strides_;
   ea::TensorImpl impl_;
   // Only used when this class manages its own data.
-  std::vector<uint8_t> managed_data_;
+  PooledBuffer managed_data_;
+  bool disposed_ = false;
+  // The env where the size of managed data was reported.
+  napi_env env_ = nullptr;
 };
 
 }  // namespace etjs
@@ -76,12 +102,20 @@ struct Type<etjs::Buffer> {
   static std::optional<etjs::Buffer> FromNode(napi_env env, napi_value value);
 };
 
+template<>
+struct Type<etjs::TypedArray> {
+  static constexpr const char* name = "TypedArray";
+  static std::optional<etjs::TypedArray> FromNode(napi_env env,
+                                                  napi_value value);
+};
+
 template<>
 struct Type<etjs::Tensor> {
   static constexpr const char* name = "Tensor";
   static void Define(napi_env env, napi_value, napi_value prototype);
   static etjs::Tensor* Constructor(
-      std::variant<etjs::Buffer, std::vector<double>> data,
+      napi_env env,
+      std::variant<etjs::TypedArray, std::vector<double>> data,
       ea::ScalarType dtype,
       std::vector<ea::SizesType> shape,
       std::vector<ea::DimOrderType> dim_order,
@@ -89,6 +123,18 @@ struct Type<etjs::Tensor> {
   static void Destructor(etjs::Tensor* ptr);
 };
 
+// Allow passing pointers of etjs::Tensor to JS, the code assumes we never free
+// the object in C++.
+template<>
+struct TypeBridge<etjs::Tensor> {
+  static inline etjs::Tensor* Wrap(etjs::Tensor* ptr) {
+    return ptr;
+  }
+  static inline void Finalize(etjs::Tensor* ptr) {
+    delete ptr;
+  }
+};
+
 }  // namespace ki
 
 #endif  // SRC_TENSOR_H_
@@ -0,0 +1,91 @@
+#include "src/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace etjs {
+
+struct ThreadPool::Job {
+  const std::function<void(size_t)>* fn;
+  size_t size;
+  std::atomic<size_t> next = 0;
+  std::atomic<size_t> done = 0;
+  ThreadPool* pool;
+};
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  for (size_t i = 0; i < num_threads; ++i)
+    workers_.emplace_back(&ThreadPool::WorkerMain, this);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mutex_);
+    quit_ = true;
+  }
+  cv_.notify_all();
+  for (std::thread& worker : workers_)
+    worker.join();
+}
+
+// static
+ThreadPool* ThreadPool::GetDefault() {
+  // Intentionally leaked to avoid joining threads in static destructors.
+  static ThreadPool* pool = new ThreadPool(
+      std::max(std::thread::hardware_concurrency(), 2u) - 1);
+  return pool;
+}
+
+void ThreadPool::ParallelFor(size_t n, const std::function<void(size_t)>& fn) {
+  if (n == 0)
+    return;
+  if (n == 1 || workers_.empty()) {
+    for (size_t i = 0; i < n; ++i)
+      fn(i);
+    return;
+  }
+  auto job = std::make_shared<Job>();
+  job->fn = &fn;
+  job->size = n;
+  job->pool = this;
+  {
+    std::lock_guard lock(mutex_);
+    jobs_.push_back(job);
+  }
+  cv_.notify_all();
+  RunJob(job.get());
+  std::unique_lock lock(mutex_);
+  done_cv_.wait(lock, [&job]() { return job->done == job->size; });
+}
+
+void ThreadPool::WorkerMain() {
+  std::unique_lock lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() { return quit_ || !jobs_.empty(); });
+    if (quit_)
+      return;
+    std::shared_ptr<Job> job = jobs_.front();
+    // All indices of the job have been taken.
+    if (job->next >= job->size) {
+      jobs_.pop_front();
+      continue;
+    }
+    lock.unlock();
+    RunJob(job.get());
+    lock.lock();
+  }
+}
+
+// static
+void ThreadPool::RunJob(Job* job) {
+  size_t i;
+  while ((i = job->next++) < job->size) {
+    (*job->fn)(i);
+    if (++job->done == job->size) {
+      std::lock_guard lock(job->pool->mutex_);
+      job->pool->done_cv_.notify_all();
+    }
+  }
+}
+
+}  // namespace etjs
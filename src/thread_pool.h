@@ -0,0 +1,51 @@
+#ifndef SRC_THREAD_POOL_H_
+#define SRC_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace etjs {
+
+// Run loops of CPU work in parallel, the calling thread also takes part in the
+// work so there is no deadlock when called from the pool's users.
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t num_threads);
+  ~ThreadPool();
+
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ThreadPool(const ThreadPool&) = delete;
+
+  // The pool shared by native code, which has one thread less than the number
+  // of cores.
+  static ThreadPool* GetDefault();
+
+  // Call |fn| for each index in [0, n) and return after all of them are done.
+  // Can be called from any thread.
+  void ParallelFor(size_t n, const std::function<void(size_t)>& fn);
+
+  size_t num_threads() const { return workers_.size(); }
+
+ private:
+  struct Job;
+
+  void WorkerMain();
+  static void RunJob(Job* job);
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+  std::deque<std::shared_ptr<Job>> jobs_;
+  bool quit_ = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace etjs
+
+#endif  // SRC_THREAD_POOL_H_
@@ -0,0 +1,150 @@
+#include "src/warmup.h"
+
+#include <executorch/runtime/core/exec_aten/util/tensor_util.h>
+#include <executorch/runtime/executor/method.h>
+#define FMT_HEADER_ONLY
+#include <fmt/format.h>
+
+#include <chrono>
+#include <memory>
+
+#include "src/error.h"
+#include "src/replica.h"
+
+namespace etjs {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MillisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// Storage of a zero-filled input tensor.
+struct SyntheticTensor {
+  std::vector<ea::SizesType> sizes;
+  std::vector<ea::DimOrderType> dim_order;
+  std::vector<ea::StridesType> strides;
+  std::vector<uint8_t> data;
+  std::unique_ptr<ea::TensorImpl> impl;
+};
+
+// Create the inputs of method from its meta, the tensors are stored in
+// |tensors| which must outlive the inputs.
+std::variant<std::string, std::vector<er::EValue>> CreateSyntheticInputs(
+    const er::MethodMeta& meta,
+    std::vector<std::unique_ptr<SyntheticTensor>>* tensors) {
+  std::vector<er::EValue> inputs;
+  for (size_t i = 0; i < meta.num_inputs(); ++i) {
+    er::Tag tag = meta.input_tag(i).get();
+    switch (tag) {
+      case er::Tag::Tensor: {
+        auto info = meta.input_tensor_meta(i);
+        auto tensor = std::make_unique<SyntheticTensor>();
+        tensor->sizes.assign(info->sizes().begin(), info->sizes().end());
+        tensor->dim_order.assign(info->dim_order().begin(),
+                                 info->dim_order().end());
+        tensor->strides.resize(tensor->sizes.size());
+        er::Error error = er::dim_order_to_stride(tensor->sizes.data(),
+                                                  tensor->dim_order.data(),
+                                                  tensor->sizes.size(),
+                                                  tensor->strides.data());
+        if (error != er::Error::Ok)
+          return ErrorCodeToMessage(error);
+        tensor->data.resize(info->nbytes());
+        tensor->impl = std::make_unique<ea::TensorImpl>(
+            info->scalar_type(),
+            tensor->sizes.size(),
+            tensor->sizes.data(),
+            tensor->data.data(),
+            tensor->dim_order.data(),
+            tensor->strides.data(),
+            ea::TensorShapeDynamism::DYNAMIC_BOUND);
+        inputs.push_back(er::EValue(ea::Tensor(tensor->impl.get())));
+        tensors->push_back(std::move(tensor));
+        break;
+      }
+      case er::Tag::Int:
+        inputs.push_back(er::EValue(static_cast<int64_t>(0)));
+        break;
+      case er::Tag::Double:
+        inputs.push_back(er::EValue(0.0));
+        break;
+      case er::Tag::Bool:
+        inputs.push_back(er::EValue(false));
+        break;
+      default:
+        return fmt::format("Can not create input {} of tag {} for warmup.",
+                           i, static_cast<int>(tag));
+    }
+  }
+  return inputs;
+}
+
+}  // namespace
+
+std::variant<std::string, WarmupResult> Warmup(
+    const std::vector<std::shared_ptr<Replica>>& replicas,
+    const std::string& name,
+    size_t iterations) {
+  WarmupResult result = {name, 0, 0};
+  std::vector<std::unique_ptr<SyntheticTensor>> tensors;
+  std::vector<er::EValue> inputs;
+  double steady_run_ms = 0;
+  for (size_t i = 0; i < replicas.size(); ++i) {
+    Replica* replica = replicas[i].get();
+    std::lock_guard lock(replica->mutex());
+    auto start = Clock::now();
+    auto method = replica->GetMethod(name);
+    if (!method.ok()) {
+      if (method.error() == er::Error::InvalidArgument)
+        return fmt::format("Method \"{}\" does not exist.", name);
+      return ErrorCodeToMessage(method.error());
+    }
+    result.load_ms += MillisecondsSince(start);
+    // All replicas share the same inputs.
+    if (i == 0) {
+      auto created = CreateSyntheticInputs((*method)->method_meta(), &tensors);
+      if (auto* error = std::get_if<std::string>(&created); error)
+        return std::move(*error);
+      inputs = std::move(std::get<std::vector<er::EValue>>(created));
+    }
+    for (size_t j = 0; j < iterations; ++j) {
+      start = Clock::now();
+      auto outputs = replica->Execute(*method, inputs);
+      if (!outputs.ok())
+        return ErrorCodeToMessage(outputs.error());
+      if (j == 0)
+        result.first_run_ms += MillisecondsSince(start);
+      else
+        steady_run_ms += MillisecondsSince(start);
+    }
+  }
+  result.first_run_ms /= replicas.size();
+  if (iterations > 1)
+    result.steady_run_ms = steady_run_ms / (replicas.size() * (iterations - 1));
+  return result;
+}
+
+}  // namespace etjs
+
+namespace ki {
+
+// static
+napi_status Type<etjs::WarmupResult>::ToNode(
+    napi_env env,
+    const etjs::WarmupResult& value,
+    napi_value* result) {
+  *result = CreateObject(env);
+  Set(env, *result,
+      "method", value.method,
+      "loadMs", value.load_ms,
+      "firstRunMs", value.first_run_ms);
+  if (value.steady_run_ms)
+    Set(env, *result, "steadyRunMs", *value.steady_run_ms);
+  return napi_ok;
+}
+
+}  // namespace ki
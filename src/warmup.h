@@ -0,0 +1,48 @@
+#ifndef SRC_WARMUP_H_
+#define SRC_WARMUP_H_
+
+#include <kizunapi.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace etjs {
+
+class Replica;
+
+struct WarmupResult {
+  std::string method;
+  // Milliseconds spent on loading the method in all replicas.
+  double load_ms;
+  // Mean milliseconds of the first execution in each replica.
+  double first_run_ms;
+  // Mean milliseconds of the following executions, if there is any.
+  std::optional<double> steady_run_ms;
+};
+
+// Load the method in |replicas| and execute it |iterations| times in each of
+// them, with zero-filled inputs of the shapes in method's meta. An error
+// message is returned on failure.
+std::variant<std::string, WarmupResult> Warmup(
+    const std::vector<std::shared_ptr<Replica>>& replicas,
+    const std::string& name,
+    size_t iterations);
+
+}  // namespace etjs
+
+namespace ki {
+
+template<>
+struct Type<etjs::WarmupResult> {
+  static constexpr const char* name = "WarmupResult";
+  static napi_status ToNode(napi_env env,
+                            const etjs::WarmupResult& value,
+                            napi_value* result);
+};
+
+}  // namespace ki
+
+#endif  // SRC_WARMUP_H_
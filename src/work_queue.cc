@@ -0,0 +1,188 @@
+#include "src/work_queue.h"
+
+#include <optional>
+
+#include "src/affinity.h"
+
+namespace etjs {
+
+// The state shared between the queue, its thread and the threadsafe function,
+// which may be destroyed in any order on exit.
+struct WorkQueue::Core {
+  struct Item {
+    Task task;
+    Reply reply;
+  };
+
+  ~Core() {
+    Join();
+  }
+
+  // Run tasks until asked to quit and there is no more task.
+  void ThreadMain() {
+    while (true) {
+      std::unique_ptr<Item> item;
+      std::optional<std::vector<uint32_t>> new_cpus;
+      {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [this]() { return quit || !items.empty(); });
+        if (items.empty())
+          break;
+        item = std::make_unique<Item>(std::move(items.front()));
+        items.pop_front();
+        new_cpus = std::move(cpus);
+        cpus.reset();
+      }
+      if (new_cpus) {
+        bool ok = SetCurrentThreadAffinity(*new_cpus);
+        std::lock_guard lock(mutex);
+        affinity_failed = !ok;
+      }
+      item->task();
+      // The item is destroyed on JS thread, so the last references held by the
+      // task are not released on this thread.
+      if (napi_call_threadsafe_function(tsfn,
+                                        item.get(),
+                                        napi_tsfn_blocking) == napi_ok) {
+        item.release();
+      }
+    }
+    // Release the reference taken for this thread when it was started.
+    napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+  }
+
+  // Ask the thread to quit after the running task, and return the tasks that
+  // will not run.
+  std::deque<Item> Quit() {
+    std::deque<Item> dropped;
+    {
+      std::lock_guard lock(mutex);
+      quit = true;
+      dropped.swap(items);
+    }
+    cv.notify_one();
+    return dropped;
+  }
+
+  void Join() {
+    if (!thread.joinable())
+      return;
+    // The last reference of the queue may be released by its own task.
+    if (thread.get_id() == std::this_thread::get_id())
+      thread.detach();
+    else
+      thread.join();
+  }
+
+  // Called on JS thread when a task is done or dropped.
+  static void OnReply(napi_env env, napi_value, void* context, void* data) {
+    std::unique_ptr<Item> item(static_cast<Item*>(data));
+    // The env is null when the threadsafe function is being destroyed.
+    if (!env)
+      return;
+    auto* core = static_cast<Core*>(context);
+    if (--core->pending == 0)
+      napi_unref_threadsafe_function(env, core->tsfn);
+    item->reply(env);
+  }
+
+  // Called on JS thread when the threadsafe function is destroyed, which
+  // happens either after the queue and its thread release it, or when env is
+  // torn down.
+  static void OnFinalize(napi_env env, void* data, void*) {
+    std::unique_ptr<std::shared_ptr<Core>> core(
+        static_cast<std::shared_ptr<Core>*>(data));
+    (*core)->Quit();
+    (*core)->Join();
+    (*core)->tsfn = nullptr;
+  }
+
+  napi_threadsafe_function tsfn = nullptr;
+  // Only accessed on JS thread.
+  size_t pending = 0;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Item> items;
+  // The affinity to apply before running next task.
+  std::optional<std::vector<uint32_t>> cpus;
+  // Whether the last affinity failed to apply.
+  bool affinity_failed = false;
+  bool quit = false;
+  std::thread thread;
+};
+
+WorkQueue::WorkQueue() : core_(std::make_shared<Core>()) {}
+
+WorkQueue::~WorkQueue() {
+  std::deque<Core::Item> dropped = core_->Quit();
+  if (!core_->tsfn)
+    return;
+  // Reply to the dropped tasks through the threadsafe function, as this may
+  // run in a finalizer where JS can not be called.
+  for (Core::Item& item : dropped) {
+    auto* data = new Core::Item{nullptr, std::move(item.reply)};
+    if (napi_call_threadsafe_function(core_->tsfn,
+                                      data,
+                                      napi_tsfn_nonblocking) != napi_ok) {
+      delete data;
+    }
+  }
+  // The thread holds its own reference, so the threadsafe function is
+  // finalized after the running task is done, without blocking here.
+  napi_release_threadsafe_function(core_->tsfn, napi_tsfn_release);
+}
+
+bool WorkQueue::Post(napi_env env, Task task, Reply reply) {
+  {
+    std::lock_guard lock(core_->mutex);
+    if (core_->quit)
+      return false;
+    if (!core_->tsfn) {
+      auto* finalize_data = new std::shared_ptr<Core>(core_);
+      // One reference for the queue and one for the thread.
+      if (napi_create_threadsafe_function(env,
+                                          nullptr,
+                                          nullptr,
+                                          ki::ToNodeValue(env, "WorkQueue"),
+                                          0,
+                                          2,
+                                          finalize_data,
+                                          &Core::OnFinalize,
+                                          core_.get(),
+                                          &Core::OnReply,
+                                          &core_->tsfn) != napi_ok) {
+        delete finalize_data;
+        return false;
+      }
+      core_->thread = std::thread(&Core::ThreadMain, core_.get());
+    }
+    core_->items.push_back({std::move(task), std::move(reply)});
+  }
+  core_->cv.notify_one();
+  // Keep the event loop alive when there are tasks running.
+  if (core_->pending++ == 0)
+    napi_ref_threadsafe_function(env, core_->tsfn);
+  return true;
+}
+
+void WorkQueue::Shutdown() {
+  core_->Quit();
+  core_->Join();
+}
+
+void WorkQueue::SetAffinity(std::vector<uint32_t> cpus) {
+  std::lock_guard lock(core_->mutex);
+  core_->cpus = std::move(cpus);
+}
+
+bool WorkQueue::affinity_failed() const {
+  std::lock_guard lock(core_->mutex);
+  return core_->affinity_failed;
+}
+
+size_t WorkQueue::pending() const {
+  return core_->pending;
+}
+
+}  // namespace etjs
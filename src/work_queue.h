@@ -0,0 +1,57 @@
+#ifndef SRC_WORK_QUEUE_H_
+#define SRC_WORK_QUEUE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <kizunapi.h>
+
+namespace etjs {
+
+// Run tasks in FIFO order on a dedicated thread, and run their replies on the
+// JS thread in the same order. Tasks and replies are destroyed on JS thread.
+class WorkQueue {
+ public:
+  using Task = std::function<void()>;
+  using Reply = std::function<void(napi_env)>;
+
+  WorkQueue();
+  // Does not wait for the running task, the tasks still queued are not run and
+  // their replies are called without running them.
+  ~WorkQueue();
+
+  WorkQueue& operator=(const WorkQueue&) = delete;
+  WorkQueue(const WorkQueue&) = delete;
+
+  // Queue the |task|, and run |reply| on JS thread after |task| is done. The
+  // thread is started on first call. Must be called on JS thread.
+  bool Post(napi_env env, Task task, Reply reply);
+
+  // Drop the queued tasks, wait for the running one and join the thread. Tasks
+  // posted later are rejected. Must be called on JS thread.
+  void Shutdown();
+
+  // Bind the thread to |cpus| before running the next task, or unbind it when
+  // |cpus| is empty. Can be called from any thread.
+  void SetAffinity(std::vector<uint32_t> cpus);
+
+  // Whether the thread failed to apply the last affinity set.
+  bool affinity_failed() const;
+
+  // Number of tasks whose replies have not run yet.
+  size_t pending() const;
+
+ private:
+  struct Core;
+
+  std::shared_ptr<Core> core_;
+};
+
+}  // namespace etjs
+
+#endif  // SRC_WORK_QUEUE_H_
@@ -1,74 +1,62 @@
 #ifndef SRC_WORKER_H_
 #define SRC_WORKER_H_
 
-#include <kizunapi.h>
+#include <optional>
 
-namespace etjs {
-
-// Shared data between main thread and worker.
-template<typename R>
-struct WorkerData {
-  napi_env env = nullptr;
-  napi_async_work work = nullptr;
-  napi_deferred deffered = nullptr;
-
-  std::function<R()> callback;
-  std::unique_ptr<R> result;
+#include "src/stats.h"
+#include "src/work_queue.h"
 
-  ~WorkerData() {
-    if (deffered) {
-      napi_reject_deferred(env, deffered,
-                           ki::ToNodeValue(env, "Worker failed."));
-    }
-    if (work) {
-      napi_delete_async_work(env, work);
-    }
-  }
-};
+namespace etjs {
 
-// Do work in worker and return a Promise that resolves on finish.
+// Do work in the queue and return a Promise that resolves on finish. When
+// |timer| is not null, the time spent in queue, replying and converting the
+// result is recorded.
 template<typename R>
-napi_value RunInWorker(napi_env env,
-                       const char* name,
-                       std::function<R()> callback) {
-  std::unique_ptr<WorkerData<R>> data = std::make_unique<WorkerData<R>>();
-  data->env = env;
-  if (napi_create_async_work(
-      env,
-      nullptr,
-      ki::ToNodeValue(env, name),
-      [](napi_env env, void* hint) {
-        auto* data = static_cast<WorkerData<R>*>(hint);
-        data->result = std::make_unique<R>(data->callback());
-      },
-      [](napi_env env, napi_status status, void* hint) {
-        auto* data = static_cast<WorkerData<R>*>(hint);
-        // Resolve promise and release everything on complete.
-        napi_resolve_deferred(env,
-                              data->deffered,
-                              ki::ToNodeValue(env, *data->result));
-        data->deffered = nullptr;
-        delete data;
-      },
-      data.get(),
-      &data->work) != napi_ok) {
-    ki::ThrowError(env, "Failed to create async work");
-    return nullptr;
-  }
+napi_value RunInQueue(napi_env env,
+                      WorkQueue* queue,
+                      std::function<R()> callback,
+                      std::shared_ptr<CallTimer> timer = nullptr) {
   // Create the returned promise.
   napi_value result;
-  if (napi_create_promise(env, &data->deffered, &result) != napi_ok) {
+  napi_deferred deferred;
+  if (napi_create_promise(env, &deferred, &result) != napi_ok) {
     ki::ThrowError(env, "Failed to create promise");
     return nullptr;
   }
-  // Start the work.
-  data->callback = std::move(callback);
-  if (napi_queue_async_work(env, data->work) != napi_ok) {
-    ki::ThrowError(env, "Failed to queue async work");
-    return nullptr;
+  // The result is written in worker and read in JS thread.
+  auto data = std::make_shared<std::optional<R>>();
+  bool posted = queue->Post(
+      env,
+      [data, timer, callback = std::move(callback)]() {
+        if (timer)
+          timer->Mark(ExecutionStats::kQueue);
+        data->emplace(callback());
+      },
+      [data, deferred, timer](napi_env env) {
+        // The task is dropped when its queue is destroyed before running it.
+        if (!data->has_value()) {
+          napi_value error;
+          napi_create_error(env, nullptr,
+                            ki::ToNodeValue(env, "Module has been closed."),
+                            &error);
+          napi_reject_deferred(env, deferred, error);
+          return;
+        }
+        if (timer)
+          timer->Mark(ExecutionStats::kReply);
+        napi_value result = ki::ToNodeValue(env, **data);
+        if (timer) {
+          timer->Mark(ExecutionStats::kConvert);
+          timer->Finish();
+        }
+        napi_resolve_deferred(env, deferred, result);
+      });
+  if (!posted) {
+    napi_value error;
+    napi_create_error(env, nullptr,
+                      ki::ToNodeValue(env, "Failed to queue work."), &error);
+    napi_reject_deferred(env, deferred, error);
   }
-  // Leak the data, which will be freed in complete handler.
-  data.release();
   return result;
 }
 
@@ -0,0 +1,71 @@
+# Export the small models used by tests into tests/fixtures.
+#
+# Usage: pip install executorch==0.4.0 && python tests/export_fixtures.py
+
+import os
+
+import torch
+from executorch.exir import to_edge
+from torch.export import Dim, export
+
+FIXTURES = os.path.join(os.path.dirname(__file__), 'fixtures')
+VOCAB_SIZE = 16
+MAX_SEQ_LEN = 4
+
+
+class TokenModel(torch.nn.Module):
+    """Return logits predicting the token after the last one of the input."""
+
+    def __init__(self):
+        super().__init__()
+        weight = torch.zeros(VOCAB_SIZE, VOCAB_SIZE)
+        for token in range(VOCAB_SIZE):
+            weight[token][(token + 1) % VOCAB_SIZE] = 10
+        self.embedding = torch.nn.Embedding.from_pretrained(weight)
+
+    def forward(self, tokens):
+        return self.embedding(tokens)
+
+
+class TokenModelWithKVCache(TokenModel):
+    """Take the start position as LLMs with KV cache, which is not used."""
+
+    def forward(self, tokens, start_pos):
+        return self.embedding(tokens)
+
+
+class BatchModel(torch.nn.Module):
+    def __init__(self):
+        super().__init__()
+        self.linear = torch.nn.Linear(4, 2)
+
+    def forward(self, x):
+        return torch.relu(self.linear(x))
+
+
+def save(name, model, args, dynamic_shapes, constant_methods=None):
+    program = to_edge(export(model, args, dynamic_shapes=dynamic_shapes),
+                      constant_methods=constant_methods).to_executorch()
+    with open(os.path.join(FIXTURES, name), 'wb') as f:
+        f.write(program.buffer)
+
+
+def main():
+    os.makedirs(FIXTURES, exist_ok=True)
+    tokens = torch.tensor([[1, 2, 3]], dtype=torch.long)
+    seq = Dim('seq', min=1, max=MAX_SEQ_LEN)
+    save('token_model.pte', TokenModel(), (tokens,), ({1: seq},))
+    save('token_model_kv.pte',
+         TokenModelWithKVCache(),
+         (tokens, torch.tensor([0], dtype=torch.long)),
+         ({1: seq}, None),
+         constant_methods={'use_kv_cache': True})
+    batch = Dim('batch', min=1, max=8)
+    save('dynamic_batch.pte',
+         BatchModel(),
+         (torch.rand(2, 4),),
+         ({0: batch},))
+
+
+if __name__ == '__main__':
+    main()
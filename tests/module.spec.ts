@@ -1,5 +1,7 @@
 import fs from 'node:fs';
-import {DType, Module, Tensor, backends, config} from '..';
+import os from 'node:os';
+import path from 'node:path';
+import {DType, GenerateOptions, Module, Tensor, backends, config, setIntraOpThreads} from '..';
 import {assert} from 'chai';
 
 const fixtures = `${__dirname}/fixtures`;
@@ -17,6 +19,331 @@ describe('Module', () => {
     assert.deepEqual(mod.getMethodNames(), [ 'forward' ]);
   });
 
+  it('load modes', () => {
+    const file = new Module(`${fixtures}/mv2.pte`, {loadMode: 'file', prefetch: 'touch'});
+    file.loadSync();
+    assert.deepEqual(file.getMethodNames(), [ 'forward' ]);
+    assert.isUndefined(file.getMemoryUsage());
+    const mod = new Module(`${fixtures}/mv2.pte`, {loadMode: 'mmap', prefetch: 'touch'});
+    mod.loadSync();
+    assert.deepEqual(mod.getMethodNames(), [ 'forward' ]);
+    const usage = mod.getMemoryUsage()!;
+    assert.equal(usage.fileBytes, fs.statSync(`${fixtures}/mv2.pte`).size);
+    assert.isAtMost(usage.residentBytes, usage.fileBytes);
+    const buffer = new Module(fs.readFileSync(`${fixtures}/mv2.pte`));
+    assert.isUndefined(buffer.getMemoryUsage());
+    assert.throws(() => new Module('mv2.pte', {loadMode: 'bad' as any}));
+  });
+
+  it('share program', async () => {
+    // Use a copy of the model, so modules left by other tests do not share it.
+    const dir = fs.mkdtempSync(`${os.tmpdir()}/etjs-`);
+    const file = `${dir}/mv2.pte`;
+    fs.copyFileSync(`${fixtures}/mv2.pte`, file);
+    try {
+      const a = new Module(file, {loadMode: 'mmap'});
+      const b = new Module(`${dir}/../${path.basename(dir)}/mv2.pte`, {loadMode: 'mmap'});
+      const c = new Module(file, {loadMode: 'mmap', shareProgram: false});
+      assert.equal(a.getProgramRefCount(), 0);
+      await Promise.all([ a.load(), b.load(), c.load() ]);
+      assert.equal(a.getProgramRefCount(), 2);
+      assert.equal(b.getProgramRefCount(), 2);
+      assert.equal(c.getProgramRefCount(), 1);
+      const {shape} = a.getMethods()[0].inputs[0];
+      const input = new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape});
+      assert.deepEqual(a.forwardSync(input).toTypedArray(), b.forwardSync(input).toTypedArray());
+    } finally {
+      fs.rmSync(dir, {recursive: true, force: true});
+    }
+  });
+
+  it('thread affinity', async () => {
+    if (process.platform == 'darwin') {
+      assert.throws(() => new Module(`${fixtures}/mv2.pte`, {cpus: [ 0 ]}));
+      return;
+    }
+    const mod = new Module(`${fixtures}/mv2.pte`, {replicas: 2, cpus: [ 0 ], pinThreads: true});
+    assert.throws(() => mod.setAffinity([ 1 << 20 ]), /not available/);
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    const input = new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape});
+    const expected = mod.forwardSync(input).toTypedArray();
+    assert.deepEqual((await mod.forward(input)).toTypedArray(), expected);
+    assert.isUndefined(mod.getAffinityError());
+    mod.setAffinity([]);
+    assert.deepEqual((await mod.forward(input)).toTypedArray(), expected);
+    assert.isUndefined(mod.getAffinityError());
+  });
+
+  it('single threaded', async () => {
+    const a = new Module(`${fixtures}/mv2.pte`);
+    const b = new Module(`${fixtures}/mv2.pte`, {singleThreaded: true});
+    assert.equal(b.getIntraOpThreads(), 1);
+    assert.isAtLeast(a.getIntraOpThreads(), 1);
+    await Promise.all([ a.load(), b.load() ]);
+    const {shape} = a.getMethods()[0].inputs[0];
+    const input = new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape});
+    assert.deepEqual((await b.forward(input)).toTypedArray(), (await a.forward(input)).toTypedArray());
+    // The threadpool can not change after methods are loaded.
+    assert.throws(() => setIntraOpThreads(2));
+  });
+
+  it('write to outputs', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`);
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    const input = new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape});
+    const output = new Tensor(Buffer.alloc(4 * 1000), DType.Float32, {shape: [ 1, 1000 ]});
+    const result = await mod.forward(input, {outputs: [ output ]});
+    assert.strictEqual(result, output);
+    const expected = mod.forwardSync(input).toTypedArray();
+    assert.deepEqual(output.toTypedArray(), expected);
+    // Later executions do not write into the tensor.
+    const other = Float32Array.from({length: getSizeFromShape(shape!)}, () => Math.random());
+    mod.forwardSync(new Tensor(other, DType.Float32, {shape}));
+    assert.deepEqual(output.toTypedArray(), expected);
+    const flat = new Tensor(new Float32Array(1000), DType.Float32, {shape: [ 1000 ]});
+    assert.throws(() => mod.forwardSync(input, {outputs: [ flat ]}), /does not match/);
+  });
+
+  it('can not dispose tensors in use', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`);
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    const input = new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape});
+    const output = new Tensor(Buffer.alloc(4 * 1000), DType.Float32, {shape: [ 1, 1000 ]});
+    const execution = mod.forward(input, {outputs: [ output ]});
+    assert.throws(() => input.dispose(), /in use/);
+    assert.throws(() => output.dispose(), /in use/);
+    await execution;
+    input.dispose();
+    output.dispose();
+    assert.isTrue(input.disposed && output.disposed);
+  });
+
+  it('shared outputs', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`);
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    const input = Tensor.createShared(shape!);
+    const output = await mod.forward(input, {sharedOutputs: true});
+    assert.isTrue(output.isShared);
+    assert.deepEqual(output.toTypedArray(), mod.forwardSync(input).toTypedArray());
+  });
+
+  it('prepared method', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`, {replicas: 2});
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    const input = new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape});
+    const forward = mod.prepare('forward');
+    assert.equal(forward.name, 'forward');
+    const expected = mod.forwardSync(input).toTypedArray();
+    assert.deepEqual((forward.executeSync(input) as Tensor).toTypedArray(), expected);
+    assert.deepEqual((await forward.execute(input) as Tensor).toTypedArray(), expected);
+    assert.throws(() => forward.executeSync(), /Expect 1 arg/);
+    assert.throws(() => mod.prepare('backward'), /does not exist/);
+  });
+
+  it('bound inputs', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`);
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    const forward = mod.prepare('forward');
+    assert.throws(() => forward.executeSync(), /Input 0 is not set/);
+    const input = new Tensor(new Float32Array(getSizeFromShape(shape!)), DType.Float32, {shape});
+    forward.setInput(0, input);
+    assert.strictEqual(forward.getInput(0), input);
+    const zeros = (forward.executeSync() as Tensor).toTypedArray();
+    // Update the data in place.
+    (input.toTypedArray() as Float32Array).fill(1);
+    const ones = (await forward.execute() as Tensor).toTypedArray();
+    assert.notDeepEqual(ones, zeros);
+    assert.deepEqual(ones, mod.forwardSync(input).toTypedArray());
+    assert.throws(() => forward.setInput(1, input), /out of range/);
+    const disposed = new Tensor(new Float32Array(getSizeFromShape(shape!)), DType.Float32, {shape});
+    disposed.dispose();
+    assert.throws(() => forward.setInput(0, disposed), /has been disposed/);
+    assert.strictEqual(forward.getInput(0), input);
+  });
+
+  it('concurrent execution', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`);
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    // The outputs of each execution are copied before the next one starts.
+    const inputs = Array.from({length: 8}, () => {
+      const data = Float32Array.from({length: getSizeFromShape(shape!)}, () => Math.random());
+      return new Tensor(new Uint8Array(data.buffer), DType.Float32, {shape});
+    });
+    const outputs = await Promise.all(inputs.map(i => mod.forward(i)));
+    for (let i = 0; i < inputs.length; ++i)
+      assert.deepEqual(outputs[i].toTypedArray(), mod.forwardSync(inputs[i]).toTypedArray());
+  });
+
+  it('replicas', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`, {replicas: 2});
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    const input = new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape});
+    const outputs = await Promise.all([ mod.forward(input), mod.forward(input) ]);
+    assert.deepEqual(outputs[0].toTypedArray(), outputs[1].toTypedArray());
+  });
+
+  it('warmup', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`, {replicas: 2});
+    await mod.load();
+    assert.isFalse(mod.isMethodLoaded('forward'));
+    await mod.loadMethod('forward');
+    assert.isTrue(mod.isMethodLoaded('forward'));
+    const results = await mod.warmup({iterations: 2});
+    assert.equal(results.length, 1);
+    assert.equal(results[0].method, 'forward');
+    assert.isAbove(results[0].firstRunMs, 0);
+    assert.isAbove(results[0].steadyRunMs!, 0);
+    await assertRejects(mod.warmup({methods: [ 'unknown' ]}), /does not exist/);
+  });
+
+  it('batching requires batch dimension', () => {
+    const mod = new Module(`${fixtures}/mv2.pte`);
+    mod.loadSync();
+    assert.throws(() => mod.enableBatching('forward'), /batch dimension/);
+    assert.isUndefined(mod.getBatchingStats('forward'));
+  });
+
+  // Exported by export_fixtures.py, which needs the executorch Python package
+  // and is run by CI on Linux.
+  const batchedModel = `${fixtures}/dynamic_batch.pte`;
+  if (fs.existsSync(batchedModel)) {
+    it('batching splits outputs per request', async () => {
+      const mod = new Module(batchedModel);
+      await mod.load();
+      const itemShape = mod.getMethods()[0].inputs[0].shape!.slice(1);
+      const inputs = [ 1, 2, 1 ].map((batchSize) => {
+        const shape = [ batchSize, ...itemShape ];
+        const data = Float32Array.from({length: getSizeFromShape(shape)}, () => Math.random());
+        return new Tensor(data, DType.Float32, {shape});
+      });
+      const expected = inputs.map(input => mod.forwardSync(input).toTypedArray());
+      mod.enableBatching('forward', {maxBatchSize: 4, maxWaitMs: 100});
+      const outputs = await Promise.all(inputs.map(input => mod.forward(input)));
+      for (let i = 0; i < inputs.length; ++i) {
+        assert.equal(outputs[i].shape[0], inputs[i].shape[0]);
+        const actual = outputs[i].toTypedArray();
+        for (let j = 0; j < actual.length; ++j)
+          assert.closeTo(actual[j] as number, expected[i][j] as number, 1e-4);
+      }
+      const {batches, requests, items} = mod.getBatchingStats('forward')!;
+      assert.deepEqual({batches, requests, items}, {batches: 1, requests: 3, items: 4});
+      const bad = new Tensor(new Float32Array(3), DType.Float32, {shape: [ 1, 3 ]});
+      await assertRejects(mod.forward(bad), /does not match/);
+    });
+  }
+
+  it('profiling', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`, {profiling: true});
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    await mod.forward(new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape}));
+    const runs = mod.getProfile(true);
+    assert.equal(runs.length, 1);
+    assert.equal(runs[0].method, 'forward');
+    assert.isAbove(runs[0].duration, 0);
+    assert.deepEqual(mod.getProfile(), []);
+    assert.throws(() => new Module(`${fixtures}/mv2.pte`).getProfile(), /profiling/);
+  });
+
+  it('cancellation', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`);
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    const input = new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape});
+    // The later executions are still queued when cancelled.
+    const controller = new AbortController();
+    const promises = [
+      mod.forward(input),
+      mod.forward(input, {signal: controller.signal}),
+      mod.forward(input, {timeout: 0}),
+      mod.forward(input, {signal: AbortSignal.abort()}),
+    ];
+    controller.abort();
+    const results = await Promise.allSettled(promises);
+    assert.equal(results[0].status, 'fulfilled');
+    assert.equal((results[1] as PromiseRejectedResult).reason.name, 'AbortError');
+    assert.match((results[2] as PromiseRejectedResult).reason.message, /timed out/);
+    assert.equal((results[3] as PromiseRejectedResult).reason.name, 'AbortError');
+  });
+
+  it('abort running execution', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`);
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    const input = new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape});
+    const controller = new AbortController();
+    const promise = mod.forward(input, {signal: controller.signal});
+    // Let the queue start the execution before aborting it.
+    await new Promise(resolve => setImmediate(resolve));
+    controller.abort();
+    await assertRejects(promise, /abort/);
+    // The rejection waits for the execution to finish.
+    input.dispose();
+  });
+
+  it('stats', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`, {collectStats: true});
+    await mod.load();
+    const {shape} = mod.getMethods()[0].inputs[0];
+    const input = new Tensor(Buffer.alloc(4 * getSizeFromShape(shape!)), DType.Float32, {shape});
+    await mod.forward(input);
+    mod.forwardSync(input);
+    const stats = mod.stats(true);
+    assert.equal(stats.calls, 2);
+    assert.equal(stats.errors, 0);
+    assert.equal(stats.allocations, 2);
+    assert.equal(stats.copiedBytes, 2 * 4 * 1000);
+    assert.equal(stats.stages.queue.count, 1);
+    assert.equal(stats.stages.execute.count, 2);
+    assert.isAbove(stats.stages.total.p99Ms, 0);
+    assert.equal(mod.stats().calls, 0);
+    assert.throws(() => new Module(`${fixtures}/mv2.pte`).stats(), /collectStats/);
+  });
+
+  it('generate requires tokens input', async () => {
+    const mod = new Module(`${fixtures}/mv2.pte`);
+    await mod.load();
+    let error: Error | undefined;
+    try {
+      for await (const token of mod.generate('forward', [1, 2, 3]))
+        assert.fail(`Unexpected token ${token}`);
+    } catch (e) {
+      error = e as Error;
+    }
+    assert.match(error!.message, /tokens/);
+  });
+
+  // Exported by export_fixtures.py, which needs the executorch Python package
+  // and is run by CI on Linux.
+  const tokenModels = [ 'token_model.pte', 'token_model_kv.pte' ].map(f => `${fixtures}/${f}`);
+  if (tokenModels.every(f => fs.existsSync(f))) {
+    it('generate tokens', async () => {
+      const generate = async (mod: Module, prompt: number[], options: GenerateOptions) => {
+        const tokens: number[] = [];
+        for await (const token of mod.generate('forward', prompt, {temperature: 0, ...options}))
+          tokens.push(token);
+        return tokens;
+      };
+      // The models predict the token after the last one. Their inputs take at
+      // most 4 tokens, so the prompt is passed in chunks with KV cache, which
+      // is read from the metadata of the model.
+      for (const file of tokenModels) {
+        const mod = new Module(file);
+        await mod.load();
+        assert.deepEqual(await generate(mod, [ 1, 2, 3, 4, 5, 6 ], {maxTokens: 4}), [ 7, 8, 9, 10 ]);
+        assert.deepEqual(await generate(mod, [ 1 ], {maxTokens: 8, stopTokens: [ 4 ]}), [ 2, 3 ]);
+      }
+    });
+  }
+
   const models = {
     cpu: 'mv2.pte',
     mps: 'mv2_mps_float16.pte',
@@ -40,3 +367,13 @@ describe('Module', () => {
 function getSizeFromShape(shape: number[]) {
   return shape.length > 0 ? shape.reduce((a, b) => a * b) : 1;
 }
+
+async function assertRejects(promise: Promise<unknown>, pattern: RegExp) {
+  try {
+    await promise;
+  } catch (error) {
+    assert.match((error as Error).message, pattern);
+    return;
+  }
+  assert.fail('Expected the promise to reject.');
+}
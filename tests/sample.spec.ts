@@ -1,4 +1,4 @@
-import {DType, Tensor, sample} from '..';
+import {DType, Generator, Tensor, sample, sampleBatch} from '..';
 import {assert} from 'chai';
 
 describe('Sample', () => {
@@ -15,4 +15,82 @@ describe('Sample', () => {
     const index = sample(new Tensor(logits, DType.BFloat16), {temperature: 0});
     assert.equal(index, 64);
   });
+
+  for (const dtype of [ DType.Float32, DType.Float16, DType.BFloat16 ]) {
+    it(`softmax ${DType[dtype]}`, () => {
+      // Use a size that is not multiple of SIMD width to cover the tail.
+      const logits = Array.from({length: 131}, () => Math.random() * 4 - 2);
+      logits[130] = 50;
+      for (let i = 0; i < 10; ++i)
+        assert.equal(sample(new Tensor(logits, dtype), {temperature: 1}), 130);
+      logits[7] = 50;
+      const indices = new Set<number>();
+      for (let i = 0; i < 100; ++i)
+        indices.add(sample(new Tensor(logits, dtype), {temperature: 1}));
+      assert.deepEqual([ ...indices ].sort((a, b) => a - b), [ 7, 130 ]);
+    });
+  }
+
+  it('topK', () => {
+    const logits = Array.from({length: 1000}, (_, i) => i / 100);
+    const indices = new Set<number>();
+    for (let i = 0; i < 200; ++i)
+      indices.add(sample(new Tensor(logits), {topK: 3}));
+    assert.isTrue([ ...indices ].every(i => i >= 997));
+  });
+
+  it('topP', () => {
+    const logits = Array.from({length: 1000}, () => 0);
+    logits[10] = logits[20] = 20;
+    const indices = new Set<number>();
+    for (let i = 0; i < 200; ++i)
+      indices.add(sample(new Tensor(logits), {topP: 0.9}));
+    assert.deepEqual([ ...indices ].sort((a, b) => a - b), [ 10, 20 ]);
+  });
+
+  it('minP', () => {
+    const logits = Array.from({length: 1000}, () => 0);
+    logits[5] = 10;
+    logits[6] = 9.9;
+    const indices = new Set<number>();
+    for (let i = 0; i < 200; ++i)
+      indices.add(sample(new Tensor(logits), {minP: 0.5}));
+    assert.deepEqual([ ...indices ].sort((a, b) => a - b), [ 5, 6 ]);
+    assert.throws(() => sample(new Tensor(logits), {topK: -1}), /topK/);
+  });
+
+  it('batch', () => {
+    const batchSize = 8;
+    const logits = Array.from({length: batchSize}, (_, i) => {
+      const row = Array.from({length: 1000}, () => Math.random());
+      row[i * 100] = 50;
+      return row;
+    });
+    const temperature = Array.from({length: batchSize}, (_, i) => i % 2);
+    const tokens = sampleBatch(new Tensor(logits), {temperature, topK: 10});
+    assert.equal(tokens.dtype, DType.Int64);
+    assert.deepEqual(tokens.shape, [ batchSize ]);
+    assert.deepEqual(tokens.tolist(), temperature.map((_, i) => i * 100));
+    const int32 = sampleBatch(new Tensor(logits), {temperature: 0, dtype: DType.Int32});
+    assert.deepEqual(int32.tolist(), temperature.map((_, i) => i * 100));
+    assert.throws(() => sampleBatch(new Tensor(logits), {topP: [ 0.5 ]}), /batch size/);
+  });
+
+  it('generator', () => {
+    const logits = new Tensor(Array.from({length: 1000}, () => Math.random()));
+    const draw = (generator: Generator) =>
+      Array.from({length: 20}, () => sample(logits, {generator}));
+    const generator = new Generator(42);
+    assert.equal(generator.seed, 42);
+    const clone = generator.clone();
+    const tokens = draw(generator);
+    assert.equal(generator.offset, 20);
+    assert.deepEqual(draw(clone), tokens);
+    assert.deepEqual(draw(new Generator(42)), tokens);
+    generator.offset = 10;
+    assert.deepEqual(draw(generator).slice(0, 10), tokens.slice(10));
+    const batch = sampleBatch(new Tensor([ logits.tolist(), logits.tolist() ]),
+                              {generator: new Generator(42)});
+    assert.deepEqual(batch.tolist(), tokens.slice(0, 2));
+  });
 });
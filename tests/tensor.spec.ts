@@ -1,4 +1,4 @@
-import {Tensor, DType} from '..';
+import {Tensor, DType, clearBufferPool, getBufferPoolStats} from '..';
 import {assert} from 'chai';
 
 describe('Tensor', () => {
@@ -62,4 +62,81 @@ describe('Tensor', () => {
     const output = new Tensor(input.data, input.dtype, {shape: input.shape});
     assert.deepEqual(input.toTypedArray(), output.toTypedArray());
   });
+
+  it('typed array', () => {
+    const input = new Float32Array([ 1, 2, 3, 4, 5, 6 ]);
+    const tensor = new Tensor(input, undefined, {shape: [ 2, 3 ]});
+    assert.equal(tensor.dtype, DType.Float32);
+    assert.deepEqual(tensor.tolist(), [ [ 1, 2, 3 ], [ 4, 5, 6 ] ]);
+    // Same dtype shares the memory.
+    input[0] = 8964;
+    assert.equal(tensor.toTypedArray()[0], 8964);
+    const int64 = new Tensor(new BigInt64Array([ 8n, 9n, 6n, 4n ]));
+    assert.equal(int64.dtype, DType.Int64);
+    assert.deepEqual(int64.shape, [ 4 ]);
+    assert.deepEqual(int64.tolist(), [ 8, 9, 6, 4 ]);
+    // Different dtype copies and casts the elements.
+    const casted = new Tensor(new Float64Array([ 1.5, 2.5 ]), DType.Int32);
+    assert.deepEqual(casted.tolist(), [ 1, 2 ]);
+    const half = new Tensor(new Int16Array([ 1, -2 ]), DType.Float16);
+    assert.deepEqual(half.tolist(), [ 1, -2 ]);
+    assert.throws(() => new Tensor(new Uint16Array(4)), /dtype/);
+    assert.throws(() => new Tensor(input, undefined, {shape: [ 2, 4 ]}), /less data/);
+  });
+
+  it('typed array conversion', () => {
+    const half = new Tensor([ [ 1, 2 ], [ 3, 4 ] ], DType.Float16);
+    assert.deepEqual(half.toTypedArray(), new Float32Array([ 1, 2, 3, 4 ]));
+    assert.deepEqual(half.toTypedArray({dtype: DType.Int64}), new BigInt64Array([ 1n, 2n, 3n, 4n ]));
+    assert.deepEqual(half.tolist(), [ [ 1, 2 ], [ 3, 4 ] ]);
+    const bf16 = new Tensor([ 0.5, 8 ], DType.BFloat16);
+    assert.deepEqual(bf16.toFloat32Array(), new Float32Array([ 0.5, 8 ]));
+    const bool = new Tensor([ true, false ]);
+    assert.deepEqual(bool.tolist(), [ true, false ]);
+    // Transposed view of [ [ 1, 2, 3 ], [ 4, 5, 6 ] ].
+    const data = new Tensor([ 1, 4, 2, 5, 3, 6 ]).data;
+    const transposed = new Tensor(data, DType.Float32, {shape: [ 2, 3 ], strides: [ 1, 2 ]});
+    assert.deepEqual(transposed.toTypedArray(), new Float32Array([ 1, 2, 3, 4, 5, 6 ]));
+    assert.deepEqual(transposed.tolist(), [ [ 1, 2, 3 ], [ 4, 5, 6 ] ]);
+  });
+
+  it('dispose', () => {
+    const tensor = new Tensor([ 1, 2, 3 ]);
+    assert.isFalse(tensor.disposed);
+    tensor.dispose();
+    assert.isTrue(tensor.disposed);
+    assert.equal(tensor.data.byteLength, 0);
+    assert.throws(() => tensor.tolist(), /disposed/);
+    // Memory owned by JS is not touched.
+    const input = new Float32Array([ 1, 2, 3 ]);
+    const view = new Tensor(input);
+    view.dispose();
+    assert.deepEqual(Array.from(input), [ 1, 2, 3 ]);
+  });
+
+  it('shared tensor', () => {
+    const tensor = Tensor.createShared([ 2, 2 ], DType.Int32);
+    assert.isTrue(tensor.isShared);
+    const view = Tensor.fromShared(tensor.share());
+    view.toTypedArray().set([ 1, 2, 3, 4 ]);
+    assert.deepEqual(tensor.tolist(), [ [ 1, 2 ], [ 3, 4 ] ]);
+    // Tensors not in SharedArrayBuffer are copied.
+    const owned = new Tensor([ 1, 2, 3 ]);
+    assert.isFalse(owned.isShared);
+    const copy = Tensor.fromShared(owned.share());
+    assert.isTrue(copy.isShared);
+    assert.deepEqual(copy.tolist(), [ 1, 2, 3 ]);
+  });
+
+  it('buffer pool', () => {
+    new Tensor(new Float32Array(1000), DType.Float16).dispose();
+    const before = getBufferPoolStats();
+    const tensor = new Tensor(new Float32Array(1000), DType.Float16);
+    const after = getBufferPoolStats();
+    assert.equal(after.reuses, before.reuses + 1);
+    assert.isAtLeast(after.inUseBytes, before.inUseBytes + tensor.nbytes);
+    tensor.dispose();
+    clearBufferPool();
+    assert.equal(getBufferPoolStats().cachedBytes, 0);
+  });
 });